@@ -0,0 +1,180 @@
+#include "Logger.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace MalgoroDE {
+
+namespace {
+
+const char* level_names[] = { "TRACE", "INFO", "WARNING", "ERROR" };
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : slots_(new Slot[CAPACITY])
+{
+    // A slot is free for position p while its sequence is p, and holds a
+    // record for the flusher once it is p + 1
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    flusher_ = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    running_.store(false, std::memory_order_release);
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+}
+
+void Logger::Record::add_string(std::string_view value) {
+    size_t length = std::min(value.size(), TEXT_SIZE - text_used);
+    std::memcpy(text + text_used, value.data(), length);
+
+    Arg& arg = args[arg_count++];
+    arg.type = Arg::Type::STRING;
+    arg.text.offset = text_used;
+    arg.text.length = length;
+    text_used += length;
+}
+
+Logger::Slot* Logger::claim() {
+    size_t position = write_position_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[position & (CAPACITY - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0) {
+            // On failure position is reloaded and the next slot tried
+            if (write_position_.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed)) {
+                return &slot;
+            }
+        } else if (difference < 0) {
+            // The flusher has not emptied this slot yet: the ring is full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = write_position_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(Slot* slot) {
+    size_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_release);
+    written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Logger::run() {
+    while (running_.load(std::memory_order_acquire)) {
+        if (!drain()) {
+            std::this_thread::sleep_for(FLUSH_INTERVAL);
+        }
+    }
+    drain();
+}
+
+bool Logger::drain() {
+    std::string out;
+    std::string errors;
+    size_t start = read_position_;
+    for (;;) {
+        Slot& slot = slots_[read_position_ & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != read_position_ + 1) {
+            break;
+        }
+        const Record& record = slot.record;
+        format(record, record.level >= LogLevel::WARNING ? errors : out);
+
+        // Hand the slot back to producers for the next lap of the ring
+        slot.sequence.store(read_position_ + CAPACITY, std::memory_order_release);
+        read_position_++;
+    }
+
+    unsigned long dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_drops_) {
+        errors += "Logger: " + std::to_string(dropped - reported_drops_) +
+                  " records dropped, ring full\n";
+        reported_drops_ = dropped;
+    }
+
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        std::fflush(stdout);
+    }
+    if (!errors.empty()) {
+        std::fwrite(errors.data(), 1, errors.size(), stderr);
+        std::fflush(stderr);
+    }
+    flushed_.store(read_position_, std::memory_order_release);
+    return read_position_ != start;
+}
+
+void Logger::format(const Record& record, std::string& out) const {
+    char buffer[64];
+
+    std::time_t seconds = std::chrono::system_clock::to_time_t(record.time);
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+        record.time.time_since_epoch()).count() % 1000;
+    std::tm local;
+    localtime_r(&seconds, &local);
+    size_t length = std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &local);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d [%s] ",
+        static_cast<int>(milliseconds), level_names[static_cast<int>(record.level)]);
+    out += buffer;
+
+    // Each "{}" takes the next argument; surplus placeholders stay as text
+    size_t next = 0;
+    for (const char* c = record.format; *c; ++c) {
+        if (c[0] != '{' || c[1] != '}' || next >= record.arg_count) {
+            out += *c;
+            continue;
+        }
+        const Arg& arg = record.args[next++];
+        switch (arg.type) {
+            case Arg::Type::INT:
+                std::snprintf(buffer, sizeof(buffer), "%lld", arg.i);
+                out += buffer;
+                break;
+            case Arg::Type::UINT:
+                std::snprintf(buffer, sizeof(buffer), "%llu", arg.u);
+                out += buffer;
+                break;
+            case Arg::Type::DOUBLE:
+                std::snprintf(buffer, sizeof(buffer), "%g", arg.d);
+                out += buffer;
+                break;
+            case Arg::Type::STRING:
+                out.append(record.text + arg.text.offset, arg.text.length);
+                break;
+        }
+        ++c;
+    }
+    out += '\n';
+}
+
+void Logger::sync() {
+    size_t target = write_position_.load(std::memory_order_acquire);
+    while (flushed_.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+Logger::Stats Logger::get_stats() const {
+    Stats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,176 @@
+#ifndef MALGORO_LOGGER_H
+#define MALGORO_LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace MalgoroDE {
+
+enum class LogLevel {
+    TRACE,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+// Records below this level are compiled out, arguments included
+#ifndef MALGORO_LOG_LEVEL
+#ifdef DEBUG
+#define MALGORO_LOG_LEVEL 0
+#else
+#define MALGORO_LOG_LEVEL 1
+#endif
+#endif
+
+#define MALGORO_LOG(level, ...)                                                         \
+    do {                                                                                \
+        if constexpr (static_cast<int>(level) >= MALGORO_LOG_LEVEL) {                   \
+            ::MalgoroDE::Logger::instance().write(level, __VA_ARGS__);                  \
+        }                                                                               \
+    } while (0)
+
+#define LOG_TRACE(...) MALGORO_LOG(::MalgoroDE::LogLevel::TRACE, __VA_ARGS__)
+#define LOG_INFO(...) MALGORO_LOG(::MalgoroDE::LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARNING(...) MALGORO_LOG(::MalgoroDE::LogLevel::WARNING, __VA_ARGS__)
+#define LOG_ERROR(...) MALGORO_LOG(::MalgoroDE::LogLevel::ERROR, __VA_ARGS__)
+
+/**
+ * @brief Asynchronous logger that never blocks the caller
+ *
+ * write() copies the format string pointer and the raw arguments into a
+ * slot of a fixed-size ring and returns; the text is only formatted by a
+ * background thread, which writes INFO and below to stdout and the rest
+ * to stderr, flushing once per drained batch. Any thread may write: slots
+ * are claimed with a compare-and-swap on the write position and published
+ * with a per-slot sequence number, so there is no lock. When the ring is
+ * full the record is dropped and counted rather than waited for.
+ *
+ * Formats use "{}" for each argument. The format must be a string literal;
+ * string arguments are copied, truncated to what fits in the record.
+ */
+class Logger {
+public:
+    static const size_t CAPACITY = 1024;       // Records; a power of two
+    static const size_t MAX_ARGS = 6;
+    static const size_t TEXT_SIZE = 160;        // Bytes for copied string arguments
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{20};
+
+    struct Stats {
+        unsigned long written = 0;
+        unsigned long dropped = 0;      // Ring full
+    };
+
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    template <typename... Args>
+    void write(LogLevel level, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+        Slot* slot = claim();
+        if (!slot) {
+            return;
+        }
+        Record* record = &slot->record;
+        record->level = level;
+        record->time = std::chrono::system_clock::now();
+        record->format = format;
+        record->arg_count = 0;
+        record->text_used = 0;
+        (record->add(args), ...);
+        publish(slot);
+    }
+
+    /**
+     * @brief Wait until everything written so far has been output
+     *
+     * For shutdown and fatal paths; never called from the event loop.
+     */
+    void sync();
+
+    Stats get_stats() const;
+
+private:
+    struct Arg {
+        enum class Type { INT, UINT, DOUBLE, STRING } type;
+        union {
+            long long i;
+            unsigned long long u;
+            double d;
+            struct {
+                unsigned short offset;
+                unsigned short length;
+            } text;
+        };
+    };
+
+    struct Record {
+        LogLevel level;
+        std::chrono::system_clock::time_point time;
+        const char* format;
+        size_t arg_count;
+        Arg args[MAX_ARGS];
+        size_t text_used;
+        char text[TEXT_SIZE];
+
+        void add_string(std::string_view value);
+
+        template <typename T>
+        void add(const T& value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                add_string(value ? "true" : "false");
+            } else if constexpr (std::is_floating_point_v<T>) {
+                Arg& arg = args[arg_count++];
+                arg.type = Arg::Type::DOUBLE;
+                arg.d = value;
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                Arg& arg = args[arg_count++];
+                arg.type = Arg::Type::INT;
+                arg.i = value;
+            } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+                Arg& arg = args[arg_count++];
+                arg.type = Arg::Type::UINT;
+                arg.u = static_cast<unsigned long long>(value);
+            } else if constexpr (std::is_pointer_v<T>) {
+                add_string(value ? std::string_view(value) : std::string_view("(null)"));
+            } else {
+                add_string(std::string_view(value));
+            }
+        }
+    };
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    Logger();
+    ~Logger();
+
+    Slot* claim();          // nullptr if the ring is full
+    void publish(Slot* slot);
+    void run();
+    bool drain();
+    void format(const Record& record, std::string& out) const;
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> write_position_{0};
+    alignas(64) size_t read_position_ = 0;      // Flusher thread only
+    std::atomic<size_t> flushed_{0};            // Records output so far
+    std::atomic<unsigned long> written_{0};
+    std::atomic<unsigned long> dropped_{0};
+    unsigned long reported_drops_ = 0;          // Flusher thread only
+    std::atomic<bool> running_{true};
+    std::thread flusher_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_LOGGER_H
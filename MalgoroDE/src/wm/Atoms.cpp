@@ -0,0 +1,90 @@
+#include "Atoms.h"
+
+namespace MalgoroDE {
+
+namespace {
+
+Atoms atom_table;
+
+struct AtomName {
+    Atom Atoms::*atom;
+    const char* name;
+};
+
+const AtomName atom_names[] = {
+    { &Atoms::wm_protocols, "WM_PROTOCOLS" },
+    { &Atoms::wm_delete_window, "WM_DELETE_WINDOW" },
+    { &Atoms::wm_state, "WM_STATE" },
+    { &Atoms::wm_change_state, "WM_CHANGE_STATE" },
+    { &Atoms::wm_take_focus, "WM_TAKE_FOCUS" },
+    { &Atoms::utf8_string, "UTF8_STRING" },
+
+    { &Atoms::net_supported, "_NET_SUPPORTED" },
+    { &Atoms::net_client_list, "_NET_CLIENT_LIST" },
+    { &Atoms::net_client_list_stacking, "_NET_CLIENT_LIST_STACKING" },
+    { &Atoms::net_number_of_desktops, "_NET_NUMBER_OF_DESKTOPS" },
+    { &Atoms::net_desktop_geometry, "_NET_DESKTOP_GEOMETRY" },
+    { &Atoms::net_desktop_viewport, "_NET_DESKTOP_VIEWPORT" },
+    { &Atoms::net_current_desktop, "_NET_CURRENT_DESKTOP" },
+    { &Atoms::net_desktop_names, "_NET_DESKTOP_NAMES" },
+    { &Atoms::net_active_window, "_NET_ACTIVE_WINDOW" },
+    { &Atoms::net_workarea, "_NET_WORKAREA" },
+    { &Atoms::net_supporting_wm_check, "_NET_SUPPORTING_WM_CHECK" },
+    { &Atoms::net_wm_name, "_NET_WM_NAME" },
+    { &Atoms::net_wm_visible_name, "_NET_WM_VISIBLE_NAME" },
+    { &Atoms::net_wm_state, "_NET_WM_STATE" },
+    { &Atoms::net_wm_state_modal, "_NET_WM_STATE_MODAL" },
+    { &Atoms::net_wm_state_sticky, "_NET_WM_STATE_STICKY" },
+    { &Atoms::net_wm_state_maximized_vert, "_NET_WM_STATE_MAXIMIZED_VERT" },
+    { &Atoms::net_wm_state_maximized_horz, "_NET_WM_STATE_MAXIMIZED_HORZ" },
+    { &Atoms::net_wm_state_shaded, "_NET_WM_STATE_SHADED" },
+    { &Atoms::net_wm_state_skip_taskbar, "_NET_WM_STATE_SKIP_TASKBAR" },
+    { &Atoms::net_wm_state_skip_pager, "_NET_WM_STATE_SKIP_PAGER" },
+    { &Atoms::net_wm_state_hidden, "_NET_WM_STATE_HIDDEN" },
+    { &Atoms::net_wm_state_fullscreen, "_NET_WM_STATE_FULLSCREEN" },
+    { &Atoms::net_wm_state_above, "_NET_WM_STATE_ABOVE" },
+    { &Atoms::net_wm_state_below, "_NET_WM_STATE_BELOW" },
+    { &Atoms::net_wm_window_type, "_NET_WM_WINDOW_TYPE" },
+    { &Atoms::net_wm_window_type_desktop, "_NET_WM_WINDOW_TYPE_DESKTOP" },
+    { &Atoms::net_wm_window_type_dock, "_NET_WM_WINDOW_TYPE_DOCK" },
+    { &Atoms::net_wm_window_type_toolbar, "_NET_WM_WINDOW_TYPE_TOOLBAR" },
+    { &Atoms::net_wm_window_type_menu, "_NET_WM_WINDOW_TYPE_MENU" },
+    { &Atoms::net_wm_window_type_utility, "_NET_WM_WINDOW_TYPE_UTILITY" },
+    { &Atoms::net_wm_window_type_splash, "_NET_WM_WINDOW_TYPE_SPLASH" },
+    { &Atoms::net_wm_window_type_dialog, "_NET_WM_WINDOW_TYPE_DIALOG" },
+    { &Atoms::net_wm_window_type_normal, "_NET_WM_WINDOW_TYPE_NORMAL" },
+    { &Atoms::net_close_window, "_NET_CLOSE_WINDOW" },
+    { &Atoms::net_moveresize_window, "_NET_MOVERESIZE_WINDOW" },
+    { &Atoms::net_wm_moveresize, "_NET_WM_MOVERESIZE" },
+    { &Atoms::net_wm_sync_request, "_NET_WM_SYNC_REQUEST" },
+    { &Atoms::net_wm_sync_request_counter, "_NET_WM_SYNC_REQUEST_COUNTER" },
+    { &Atoms::net_wm_strut, "_NET_WM_STRUT" },
+    { &Atoms::net_wm_strut_partial, "_NET_WM_STRUT_PARTIAL" },
+
+    { &Atoms::malgoro_unredirected, "_MALGORO_UNREDIRECTED" },
+};
+
+const int atom_count = sizeof(atom_names) / sizeof(atom_names[0]);
+
+} // namespace
+
+bool intern_atoms(Display* display) {
+    char* names[atom_count];
+    Atom values[atom_count];
+    for (int i = 0; i < atom_count; ++i) {
+        names[i] = const_cast<char*>(atom_names[i].name);
+    }
+
+    Status status = XInternAtoms(display, names, atom_count, False, values);
+
+    for (int i = 0; i < atom_count; ++i) {
+        atom_table.*atom_names[i].atom = values[i];
+    }
+    return status != 0;
+}
+
+const Atoms& atoms() {
+    return atom_table;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,80 @@
+#ifndef MALGORO_ATOMS_H
+#define MALGORO_ATOMS_H
+
+#include <X11/Xlib.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Interned X11 atoms shared by every window manager class
+ */
+struct Atoms {
+    // ICCCM atoms
+    Atom wm_protocols;
+    Atom wm_delete_window;
+    Atom wm_state;
+    Atom wm_change_state;
+    Atom wm_take_focus;
+    Atom utf8_string;
+
+    // EWMH atoms
+    Atom net_supported;
+    Atom net_client_list;
+    Atom net_client_list_stacking;
+    Atom net_number_of_desktops;
+    Atom net_desktop_geometry;
+    Atom net_desktop_viewport;
+    Atom net_current_desktop;
+    Atom net_desktop_names;
+    Atom net_active_window;
+    Atom net_workarea;
+    Atom net_supporting_wm_check;
+    Atom net_wm_name;
+    Atom net_wm_visible_name;
+    Atom net_wm_state;
+    Atom net_wm_state_modal;
+    Atom net_wm_state_sticky;
+    Atom net_wm_state_maximized_vert;
+    Atom net_wm_state_maximized_horz;
+    Atom net_wm_state_shaded;
+    Atom net_wm_state_skip_taskbar;
+    Atom net_wm_state_skip_pager;
+    Atom net_wm_state_hidden;
+    Atom net_wm_state_fullscreen;
+    Atom net_wm_state_above;
+    Atom net_wm_state_below;
+    Atom net_wm_window_type;
+    Atom net_wm_window_type_desktop;
+    Atom net_wm_window_type_dock;
+    Atom net_wm_window_type_toolbar;
+    Atom net_wm_window_type_menu;
+    Atom net_wm_window_type_utility;
+    Atom net_wm_window_type_splash;
+    Atom net_wm_window_type_dialog;
+    Atom net_wm_window_type_normal;
+    Atom net_close_window;
+    Atom net_moveresize_window;
+    Atom net_wm_moveresize;
+    Atom net_wm_sync_request;
+    Atom net_wm_sync_request_counter;
+    Atom net_wm_strut;
+    Atom net_wm_strut_partial;
+
+    // Malgoro atoms
+    Atom malgoro_unredirected;
+};
+
+/**
+ * @brief Intern every atom in one XInternAtoms round trip
+ * @return true if all atoms were interned
+ */
+bool intern_atoms(Display* display);
+
+/**
+ * @brief Process-wide atom table, filled by intern_atoms()
+ */
+const Atoms& atoms();
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_ATOMS_H
@@ -0,0 +1,730 @@
+#include "Compositor.h"
+#include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/shape.h>
+#include <algorithm>
+
+namespace MalgoroDE {
+
+Compositor::Compositor(Display* display, int screen, ::Window root)
+    : display_(display)
+    , screen_(screen)
+    , root_(root)
+    , root_width_(DisplayWidth(display, screen))
+    , root_height_(DisplayHeight(display, screen))
+    , active_(false)
+    , damage_event_base_(0)
+    , shape_event_base_(0)
+    , overlay_(None)
+    , overlay_picture_(None)
+    , back_buffer_(None)
+    , back_picture_(None)
+    , background_(None)
+    , unredirect_serial_(0)
+    , damage_(XCreateRegion())
+    , remaining_(XCreateRegion())
+{
+}
+
+Compositor::~Compositor() {
+    if (active_) {
+        for (auto& entry : toplevels_) {
+            TopLevel& toplevel = entry.second;
+            if (toplevel.unredirected) {
+                // Restore the per-window redirect so the subwindow redirect
+                // below releases every window alike
+                XCompositeRedirectWindow(display_, toplevel.id, CompositeRedirectManual);
+            }
+            if (toplevel.picture != None) {
+                XRenderFreePicture(display_, toplevel.picture);
+            }
+            if (toplevel.damage != None) {
+                XDamageDestroy(display_, toplevel.damage);
+            }
+            if (toplevel.shape) {
+                XDestroyRegion(toplevel.shape);
+            }
+        }
+
+        XRenderFreePicture(display_, background_);
+        XRenderFreePicture(display_, back_picture_);
+        XFreePixmap(display_, back_buffer_);
+        XRenderFreePicture(display_, overlay_picture_);
+        XCompositeReleaseOverlayWindow(display_, root_);
+        XCompositeUnredirectSubwindows(display_, root_, CompositeRedirectManual);
+    }
+
+    XDestroyRegion(remaining_);
+    XDestroyRegion(damage_);
+}
+
+bool Compositor::initialize() {
+    int event_base, error_base;
+    int major, minor;
+
+    // The overlay window needs Composite 0.3, solid fills Render 0.10
+    if (!XCompositeQueryExtension(display_, &event_base, &error_base)) {
+        return false;
+    }
+    major = 0;
+    minor = 3;
+    XCompositeQueryVersion(display_, &major, &minor);
+    if (major == 0 && minor < 3) {
+        return false;
+    }
+    if (!XRenderQueryExtension(display_, &event_base, &error_base)) {
+        return false;
+    }
+    major = 0;
+    minor = 10;
+    XRenderQueryVersion(display_, &major, &minor);
+    if (major == 0 && minor < 10) {
+        return false;
+    }
+    if (!XDamageQueryExtension(display_, &damage_event_base_, &error_base) ||
+        !XFixesQueryExtension(display_, &event_base, &error_base) ||
+        !XShapeQueryExtension(display_, &shape_event_base_, &error_base)) {
+        return false;
+    }
+
+    // Hold the server so no window slips between the redirect and the scan
+    XGrabServer(display_);
+
+    XCompositeRedirectSubwindows(display_, root_, CompositeRedirectManual);
+
+    // The overlay sits above every window; make it transparent to input
+    overlay_ = XCompositeGetOverlayWindow(display_, root_);
+    XserverRegion empty = XFixesCreateRegion(display_, nullptr, 0);
+    XFixesSetWindowShapeRegion(display_, overlay_, ShapeInput, 0, 0, empty);
+    XFixesDestroyRegion(display_, empty);
+
+    XRenderPictFormat* format = XRenderFindVisualFormat(display_, DefaultVisual(display_, screen_));
+    XRenderPictureAttributes attrs;
+    attrs.subwindow_mode = IncludeInferiors;
+    overlay_picture_ = XRenderCreatePicture(display_, overlay_, format, CPSubwindowMode, &attrs);
+
+    back_buffer_ = XCreatePixmap(display_, root_, root_width_, root_height_,
+        DefaultDepth(display_, screen_));
+    back_picture_ = XRenderCreatePicture(display_, back_buffer_, format, 0, nullptr);
+
+    // Desktop colour, shown wherever no window is mapped
+    XRenderColor color = { 0x3a3a, 0x6e6e, 0xa5a5, 0xffff };
+    background_ = XRenderCreateSolidFill(display_, &color);
+
+    // A single output covering the screen until set_outputs()
+    XRectangle screen_rect = { 0, 0, (unsigned short)root_width_, (unsigned short)root_height_ };
+    outputs_.assign(1, screen_rect);
+
+    active_ = true;
+
+    ::Window returned_root, returned_parent;
+    ::Window* children = nullptr;
+    unsigned int count = 0;
+    if (XQueryTree(display_, root_, &returned_root, &returned_parent, &children, &count)) {
+        // XQueryTree lists children bottom to top
+        for (unsigned int i = 0; i < count; ++i) {
+            add_toplevel(children[i]);
+        }
+        if (children) {
+            XFree(children);
+        }
+    }
+
+    XUngrabServer(display_);
+
+    damage_rect(0, 0, root_width_, root_height_);
+    last_frame_ = std::chrono::steady_clock::now() - FRAME_INTERVAL;
+    return true;
+}
+
+bool Compositor::handle_event(const XEvent& event) {
+    if (!active_) {
+        return false;
+    }
+
+    switch (event.type) {
+        case CreateNotify:
+            if (event.xcreatewindow.parent == root_) {
+                add_toplevel(event.xcreatewindow.window);
+            }
+            break;
+
+        case DestroyNotify:
+            if (event.xdestroywindow.event == root_) {
+                remove_toplevel(event.xdestroywindow.window, true);
+            }
+            break;
+
+        case ReparentNotify:
+            if (event.xreparent.event != root_) {
+                break;
+            }
+            if (event.xreparent.parent == root_) {
+                add_toplevel(event.xreparent.window);
+            } else {
+                // e.g. a client reparented into its frame
+                remove_toplevel(event.xreparent.window, false);
+            }
+            break;
+
+        case MapNotify:
+            if (event.xmap.event == root_) {
+                if (TopLevel* toplevel = find(event.xmap.window)) {
+                    map_toplevel(*toplevel);
+                }
+            }
+            break;
+
+        case UnmapNotify:
+            if (event.xunmap.event == root_) {
+                if (TopLevel* toplevel = find(event.xunmap.window)) {
+                    unmap_toplevel(*toplevel);
+                }
+            }
+            break;
+
+        case ConfigureNotify: {
+            const XConfigureEvent& configure = event.xconfigure;
+            if (configure.window == root_) {
+                // Screen size change: rebuild the back buffer at the new size
+                root_width_ = configure.width;
+                root_height_ = configure.height;
+                XRenderFreePicture(display_, back_picture_);
+                XFreePixmap(display_, back_buffer_);
+                back_buffer_ = XCreatePixmap(display_, root_, root_width_, root_height_,
+                    DefaultDepth(display_, screen_));
+                back_picture_ = XRenderCreatePicture(display_, back_buffer_,
+                    XRenderFindVisualFormat(display_, DefaultVisual(display_, screen_)), 0, nullptr);
+                damage_rect(0, 0, root_width_, root_height_);
+                break;
+            }
+            if (configure.event != root_) {
+                break;
+            }
+
+            TopLevel* toplevel = find(configure.window);
+            if (!toplevel) {
+                break;
+            }
+            if (toplevel->mapped) {
+                damage_toplevel(*toplevel);
+            }
+            toplevel->x = configure.x + configure.border_width;
+            toplevel->y = configure.y + configure.border_width;
+            toplevel->width = configure.width;
+            toplevel->height = configure.height;
+            toplevel->border_width = configure.border_width;
+            restack(configure.window, configure.above);
+            if (toplevel->mapped) {
+                damage_toplevel(*toplevel);
+            }
+            if (toplevel->unredirected) {
+                reshape_overlay();
+            }
+            break;
+        }
+
+        case CirculateNotify:
+            if (event.xcirculate.event == root_) {
+                ::Window window = event.xcirculate.window;
+                if (TopLevel* toplevel = find(window)) {
+                    stack_.erase(std::find(stack_.begin(), stack_.end(), window));
+                    if (event.xcirculate.place == PlaceOnTop) {
+                        stack_.push_back(window);
+                    } else {
+                        stack_.insert(stack_.begin(), window);
+                    }
+                    if (toplevel->mapped) {
+                        damage_toplevel(*toplevel);
+                    }
+                }
+            }
+            break;
+
+        default:
+            if (event.type == damage_event_base_ + XDamageNotify) {
+                const XDamageNotifyEvent& notify = reinterpret_cast<const XDamageNotifyEvent&>(event);
+                stats_.damage_events++;
+
+                TopLevel* toplevel = find(notify.drawable);
+                if (toplevel && toplevel->mapped) {
+                    damage_rect(toplevel->x + notify.area.x, toplevel->y + notify.area.y,
+                        notify.area.width, notify.area.height);
+                }
+
+                // Delta reports stop once the damage region stops growing;
+                // reset it after the last event of a burst
+                if (!notify.more) {
+                    XDamageSubtract(display_, notify.damage, None, None);
+                }
+                return true;
+            }
+            if (event.type == shape_event_base_ + ShapeNotify) {
+                const XShapeEvent& notify = reinterpret_cast<const XShapeEvent&>(event);
+                TopLevel* toplevel = find(notify.window);
+                if (toplevel && notify.kind == ShapeBounding) {
+                    // Both the old and the new shape lie within the window
+                    if (toplevel->mapped) {
+                        damage_toplevel(*toplevel);
+                    }
+                    update_shape(*toplevel, notify.shaped);
+                }
+                return true;
+            }
+            break;
+    }
+
+    return false;
+}
+
+int Compositor::get_repaint_delay() const {
+    if (!active_ || XEmptyRegion(damage_)) {
+        return -1;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - last_frame_;
+    if (elapsed >= FRAME_INTERVAL) {
+        return 0;
+    }
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(FRAME_INTERVAL - elapsed);
+    return static_cast<int>(remaining.count());
+}
+
+bool Compositor::paint_if_due() {
+    if (get_repaint_delay() != 0) {
+        return false;
+    }
+
+    // Stacking, geometry and mapping changes all damage the screen, so
+    // this runs whenever the candidate for unredirection may have changed
+    update_unredirection();
+
+    auto start = std::chrono::steady_clock::now();
+    last_frame_ = start;
+    if (!paint()) {
+        return false;
+    }
+
+    stats_.frames++;
+    stats_.paint_time += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    return true;
+}
+
+void Compositor::add_toplevel(::Window id) {
+    if (id == overlay_ || toplevels_.count(id)) {
+        return;
+    }
+
+    XWindowAttributes attrs;
+    if (!XGetWindowAttributes(display_, id, &attrs)) {
+        return;
+    }
+
+    TopLevel& toplevel = toplevels_[id];
+    toplevel.id = id;
+    toplevel.x = attrs.x + attrs.border_width;
+    toplevel.y = attrs.y + attrs.border_width;
+    toplevel.width = attrs.width;
+    toplevel.height = attrs.height;
+    toplevel.border_width = attrs.border_width;
+    toplevel.input_only = attrs.c_class == InputOnly;
+
+    if (!toplevel.input_only) {
+        toplevel.format = XRenderFindVisualFormat(display_, attrs.visual);
+        toplevel.has_alpha = toplevel.format && toplevel.format->type == PictTypeDirect &&
+            toplevel.format->direct.alphaMask;
+        toplevel.damage = XDamageCreate(display_, id, XDamageReportDeltaRectangles);
+
+        XShapeSelectInput(display_, id, ShapeNotifyMask);
+        Bool bounding_shaped, clip_shaped;
+        int x, y;
+        unsigned int width, height;
+        if (XShapeQueryExtents(display_, id, &bounding_shaped, &x, &y, &width, &height,
+                &clip_shaped, &x, &y, &width, &height)) {
+            update_shape(toplevel, bounding_shaped);
+        }
+    }
+
+    // New windows start at the top of the stack
+    stack_.push_back(id);
+
+    if (attrs.map_state == IsViewable) {
+        map_toplevel(toplevel);
+    }
+}
+
+void Compositor::remove_toplevel(::Window id, bool destroyed) {
+    auto it = toplevels_.find(id);
+    if (it == toplevels_.end()) {
+        return;
+    }
+
+    TopLevel& toplevel = it->second;
+    if (toplevel.mapped) {
+        unmap_toplevel(toplevel);
+    }
+
+    if (toplevel.unredirected) {
+        // Reparented windows get the redirect back; destroyed ones need none
+        if (!destroyed) {
+            XCompositeRedirectWindow(display_, id, CompositeRedirectManual);
+            toplevel.damage = XDamageCreate(display_, id, XDamageReportDeltaRectangles);
+        }
+        unredirected_.erase(std::find(unredirected_.begin(), unredirected_.end(), id));
+        unredirect_serial_++;
+        reshape_overlay();
+    }
+
+    // A destroyed window's Damage goes with it
+    if (!destroyed && toplevel.damage != None) {
+        XDamageDestroy(display_, toplevel.damage);
+    }
+    if (toplevel.shape) {
+        XDestroyRegion(toplevel.shape);
+    }
+
+    toplevels_.erase(it);
+    stack_.erase(std::find(stack_.begin(), stack_.end(), id));
+}
+
+void Compositor::restack(::Window id, ::Window above) {
+    auto current = std::find(stack_.begin(), stack_.end(), id);
+    if (current == stack_.end()) {
+        return;
+    }
+    stack_.erase(current);
+
+    // Place directly above the sibling, or at the bottom if there is none
+    auto sibling = above != None ? std::find(stack_.begin(), stack_.end(), above) : stack_.end();
+    stack_.insert(sibling == stack_.end() ? stack_.begin() : sibling + 1, id);
+}
+
+void Compositor::map_toplevel(TopLevel& toplevel) {
+    toplevel.mapped = true;
+    damage_toplevel(toplevel);
+}
+
+void Compositor::unmap_toplevel(TopLevel& toplevel) {
+    // Expose whatever was underneath
+    damage_toplevel(toplevel);
+    toplevel.mapped = false;
+
+    if (toplevel.picture != None) {
+        XRenderFreePicture(display_, toplevel.picture);
+        toplevel.picture = None;
+    }
+}
+
+void Compositor::damage_toplevel(const TopLevel& toplevel) {
+    if (!toplevel.input_only) {
+        damage_rect(toplevel.x, toplevel.y, toplevel.width, toplevel.height);
+    }
+}
+
+void Compositor::damage_rect(int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    XRectangle rect;
+    rect.x = x;
+    rect.y = y;
+    rect.width = width;
+    rect.height = height;
+    XUnionRectWithRegion(&rect, damage_, damage_);
+}
+
+void Compositor::update_shape(TopLevel& toplevel, bool shaped) {
+    if (toplevel.shape) {
+        XDestroyRegion(toplevel.shape);
+        toplevel.shape = nullptr;
+    }
+    if (!shaped) {
+        return;
+    }
+
+    int count = 0, ordering;
+    XRectangle* rects = XShapeGetRectangles(display_, toplevel.id, ShapeBounding, &count, &ordering);
+    toplevel.shape = XCreateRegion();
+    for (int i = 0; i < count; ++i) {
+        XUnionRectWithRegion(&rects[i], toplevel.shape, toplevel.shape);
+    }
+    if (rects) {
+        XFree(rects);
+    }
+}
+
+Region Compositor::get_region(const TopLevel& toplevel) const {
+    XRectangle rect;
+    rect.x = toplevel.x;
+    rect.y = toplevel.y;
+    rect.width = toplevel.width;
+    rect.height = toplevel.height;
+    Region region = XCreateRegion();
+    XUnionRectWithRegion(&rect, region, region);
+
+    // A shape may reach past the window; only its part inside counts
+    if (toplevel.shape) {
+        Region shape = XCreateRegion();
+        XUnionRegion(shape, toplevel.shape, shape);
+        XOffsetRegion(shape, toplevel.x, toplevel.y);
+        XIntersectRegion(region, shape, region);
+        XDestroyRegion(shape);
+    }
+    return region;
+}
+
+Compositor::TopLevel* Compositor::find(::Window id) {
+    auto it = toplevels_.find(id);
+    return it != toplevels_.end() ? &it->second : nullptr;
+}
+
+bool Compositor::paint() {
+    if (!render()) {
+        return false;
+    }
+    present();
+    return true;
+}
+
+bool Compositor::render() {
+    // Unredirected windows scan out directly; nothing under them is shown
+    for (::Window id : unredirected_) {
+        const TopLevel& toplevel = toplevels_[id];
+        XRectangle rect;
+        rect.x = toplevel.x;
+        rect.y = toplevel.y;
+        rect.width = toplevel.width;
+        rect.height = toplevel.height;
+        Region covered = XCreateRegion();
+        XUnionRectWithRegion(&rect, covered, covered);
+        XSubtractRegion(damage_, covered, damage_);
+        XDestroyRegion(covered);
+    }
+    if (XEmptyRegion(damage_)) {
+        return false;
+    }
+
+    // Top-down pass: opaque windows are painted straight into the back
+    // buffer and removed from what remains to be painted, so anything they
+    // cover is never touched. Translucent windows keep the region visible
+    // at their level and are blended bottom-up afterwards.
+    XSubtractRegion(remaining_, remaining_, remaining_);
+    XUnionRegion(remaining_, damage_, remaining_);
+
+    for (size_t i = stack_.size(); i-- > 0;) {
+        TopLevel& toplevel = toplevels_[stack_[i]];
+        if (!toplevel.mapped || toplevel.input_only || !toplevel.format || toplevel.unredirected) {
+            continue;
+        }
+
+        if (XRectInRegion(remaining_, toplevel.x, toplevel.y,
+                toplevel.width, toplevel.height) == RectangleOut) {
+            if (XRectInRegion(damage_, toplevel.x, toplevel.y,
+                    toplevel.width, toplevel.height) != RectangleOut) {
+                stats_.windows_occluded++;
+            }
+            continue;
+        }
+
+        Region covered = get_region(toplevel);
+        if (toplevel.has_alpha || toplevel.shape) {
+            Region clip = XCreateRegion();
+            XIntersectRegion(remaining_, covered, clip);
+            if (toplevel.has_alpha) {
+                translucent_.emplace_back(&toplevel, clip);
+                XDestroyRegion(covered);
+                continue;
+            }
+            paint_toplevel(toplevel, clip, PictOpSrc);
+            XDestroyRegion(clip);
+        } else {
+            paint_toplevel(toplevel, remaining_, PictOpSrc);
+        }
+
+        XSubtractRegion(remaining_, covered, remaining_);
+        XDestroyRegion(covered);
+    }
+
+    if (!XEmptyRegion(remaining_)) {
+        XRenderSetPictureClipRegion(display_, back_picture_, remaining_);
+        XRenderComposite(display_, PictOpSrc, background_, None, back_picture_,
+            0, 0, 0, 0, 0, 0, root_width_, root_height_);
+    }
+
+    for (auto it = translucent_.rbegin(); it != translucent_.rend(); ++it) {
+        paint_toplevel(*it->first, it->second, PictOpOver);
+        XDestroyRegion(it->second);
+    }
+    translucent_.clear();
+
+    XRenderPictureAttributes attrs;
+    attrs.clip_mask = None;
+    XRenderChangePicture(display_, back_picture_, CPClipMask, &attrs);
+    return true;
+}
+
+void Compositor::present() {
+    // Only the damaged area is copied to the overlay
+    XRectangle bounds;
+    XClipBox(damage_, &bounds);
+    XRenderSetPictureClipRegion(display_, overlay_picture_, damage_);
+    XRenderComposite(display_, PictOpSrc, back_picture_, None, overlay_picture_,
+        bounds.x, bounds.y, 0, 0, bounds.x, bounds.y, bounds.width, bounds.height);
+
+    stats_.pixels_painted += static_cast<unsigned long long>(bounds.width) * bounds.height;
+    XSubtractRegion(damage_, damage_, damage_);
+}
+
+void Compositor::paint_toplevel(TopLevel& toplevel, Region clip, int op) {
+    if (toplevel.picture == None) {
+        // Reads the window's off-screen storage, which follows resizes
+        XRenderPictureAttributes attrs;
+        attrs.subwindow_mode = IncludeInferiors;
+        toplevel.picture = XRenderCreatePicture(display_, toplevel.id, toplevel.format,
+            CPSubwindowMode, &attrs);
+    }
+
+    XRenderSetPictureClipRegion(display_, back_picture_, clip);
+    XRenderComposite(display_, op, toplevel.picture, None, back_picture_,
+        0, 0, 0, 0, toplevel.x, toplevel.y, toplevel.width, toplevel.height);
+    stats_.windows_painted++;
+}
+
+void Compositor::set_outputs(const std::vector<XRectangle>& outputs) {
+    if (outputs.empty()) {
+        return;
+    }
+    outputs_ = outputs;
+
+    // Unredirection is re-evaluated per output at the next frame
+    damage_rect(0, 0, root_width_, root_height_);
+    if (!unredirected_.empty()) {
+        reshape_overlay();
+    }
+}
+
+void Compositor::update_unredirection() {
+    // The topmost mapped window touching an output is that output's only
+    // candidate, and only if it is opaque and covers the output entirely
+    candidates_.clear();
+    for (const XRectangle& output : outputs_) {
+        for (size_t i = stack_.size(); i-- > 0;) {
+            const TopLevel& toplevel = toplevels_[stack_[i]];
+            if (!toplevel.mapped || toplevel.input_only) {
+                continue;
+            }
+            if (toplevel.x >= output.x + output.width || toplevel.y >= output.y + output.height ||
+                toplevel.x + toplevel.width <= output.x || toplevel.y + toplevel.height <= output.y) {
+                continue;
+            }
+            if (!toplevel.has_alpha && !toplevel.shape && toplevel.x <= output.x && toplevel.y <= output.y &&
+                toplevel.x + toplevel.width >= output.x + output.width &&
+                toplevel.y + toplevel.height >= output.y + output.height) {
+                candidates_.push_back(toplevel.id);
+            }
+            break;
+        }
+    }
+
+    auto is_candidate = [this](::Window id) {
+        return std::find(candidates_.begin(), candidates_.end(), id) != candidates_.end();
+    };
+
+    // Windows that lost their output go back behind the overlay. Under a
+    // server grab: composite a full frame while the window still scans out
+    // (its picture reads the same pixels), restore the overlay over it,
+    // present, and only then redirect, so the screen never shows anything
+    // but the window's own contents.
+    if (std::any_of(unredirected_.begin(), unredirected_.end(),
+            [&](::Window id) { return !is_candidate(id); })) {
+        XGrabServer(display_);
+
+        std::vector<::Window> redirected;
+        for (auto it = unredirected_.begin(); it != unredirected_.end();) {
+            if (is_candidate(*it)) {
+                ++it;
+                continue;
+            }
+            TopLevel& toplevel = toplevels_[*it];
+            toplevel.unredirected = false;
+            damage_toplevel(toplevel);
+            redirected.push_back(*it);
+            it = unredirected_.erase(it);
+        }
+
+        // The frame must be read before the overlay obscures the window
+        bool rendered = render();
+        reshape_overlay();
+        if (rendered) {
+            present();
+            stats_.frames++;
+        }
+        for (::Window id : redirected) {
+            redirect_toplevel(toplevels_[id]);
+        }
+
+        XUngrabServer(display_);
+        unredirect_serial_++;
+    }
+
+    // New candidates: the server copies each window's last contents to the
+    // screen under the overlay, so uncovering it shows the same image
+    bool added = false;
+    for (::Window id : candidates_) {
+        TopLevel& toplevel = toplevels_[id];
+        if (!toplevel.unredirected) {
+            unredirect_toplevel(toplevel);
+            unredirected_.push_back(id);
+            added = true;
+        }
+    }
+    if (added) {
+        reshape_overlay();
+        unredirect_serial_++;
+    }
+}
+
+void Compositor::redirect_toplevel(TopLevel& toplevel) {
+    XCompositeRedirectWindow(display_, toplevel.id, CompositeRedirectManual);
+    toplevel.damage = XDamageCreate(display_, toplevel.id, XDamageReportDeltaRectangles);
+    stats_.redirects++;
+}
+
+void Compositor::unredirect_toplevel(TopLevel& toplevel) {
+    XCompositeUnredirectWindow(display_, toplevel.id, CompositeRedirectManual);
+
+    // Drawing to the window no longer concerns the compositor
+    if (toplevel.damage != None) {
+        XDamageDestroy(display_, toplevel.damage);
+        toplevel.damage = None;
+    }
+    toplevel.unredirected = true;
+    stats_.unredirects++;
+}
+
+void Compositor::reshape_overlay() {
+    if (unredirected_.empty()) {
+        XFixesSetWindowShapeRegion(display_, overlay_, ShapeBounding, 0, 0, None);
+        return;
+    }
+
+    // Cover every output except where unredirected windows scan out
+    XserverRegion region = XFixesCreateRegion(display_, outputs_.data(), outputs_.size());
+    for (::Window id : unredirected_) {
+        const TopLevel& toplevel = toplevels_[id];
+        XRectangle rect;
+        rect.x = toplevel.x;
+        rect.y = toplevel.y;
+        rect.width = toplevel.width;
+        rect.height = toplevel.height;
+        XserverRegion window = XFixesCreateRegion(display_, &rect, 1);
+        XFixesSubtractRegion(display_, region, region, window);
+        XFixesDestroyRegion(display_, window);
+    }
+    XFixesSetWindowShapeRegion(display_, overlay_, ShapeBounding, 0, 0, region);
+    XFixesDestroyRegion(display_, region);
+}
+
+} // namespace MalgoroDE
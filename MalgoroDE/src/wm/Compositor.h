@@ -0,0 +1,170 @@
+#ifndef MALGORO_COMPOSITOR_H
+#define MALGORO_COMPOSITOR_H
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xrender.h>
+#include <X11/extensions/Xdamage.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief In-process XRender compositor
+ *
+ * Redirects every top-level window off-screen and composites them into
+ * the Composite overlay window through a back buffer. Damage is tracked
+ * per window (XDamage delta rectangles) and accumulated into one region;
+ * each frame repaints only that region, at most once per FRAME_INTERVAL.
+ * Windows entirely covered by opaque windows above them are skipped.
+ *
+ * The compositor keeps its own bottom-to-top list of the root's children,
+ * maintained from the SubstructureNotify events the WM already selects.
+ *
+ * An opaque window that covers a whole output with nothing above it is
+ * unredirected: it scans out directly, its damage is no longer tracked,
+ * and the overlay is shaped to leave its area uncovered.
+ *
+ * Windows with a bounding shape (e.g. frames with rounded corners) are
+ * painted through their shape, so whatever lies beneath the cut-away
+ * parts still shows.
+ */
+class Compositor {
+public:
+    struct Stats {
+        unsigned long frames = 0;
+        unsigned long damage_events = 0;
+        unsigned long windows_painted = 0;
+        unsigned long windows_occluded = 0;     // Skipped: covered by opaque windows
+        unsigned long long pixels_painted = 0;  // Sum of each frame's repaint bounding box
+        std::chrono::microseconds paint_time{0};
+        unsigned long unredirects = 0;
+        unsigned long redirects = 0;
+    };
+
+    Compositor(Display* display, int screen, ::Window root);
+    ~Compositor();
+
+    Compositor(const Compositor&) = delete;
+    Compositor& operator=(const Compositor&) = delete;
+
+    /**
+     * @brief Check for the extensions, redirect windows and set up the overlay
+     * @return false if compositing is unavailable (nothing is redirected)
+     */
+    bool initialize();
+
+    /**
+     * @brief Track window tree changes and damage
+     *
+     * Called for every event; structure events are observed, not consumed.
+     * @return true if the event was a Damage or Shape event
+     */
+    bool handle_event(const XEvent& event);
+
+    /**
+     * @brief Replace the output rectangles used for unredirection
+     */
+    void set_outputs(const std::vector<XRectangle>& outputs);
+
+    /**
+     * @brief Milliseconds until the next frame is due
+     * @return -1 if nothing is damaged, 0 if a frame is due now
+     */
+    int get_repaint_delay() const;
+
+    /**
+     * @brief Repaint the damaged region if a frame is due
+     * @return true if a frame was presented
+     */
+    bool paint_if_due();
+
+    /**
+     * @brief Top-level windows currently bypassing the compositor
+     */
+    const std::vector<::Window>& get_unredirected() const { return unredirected_; }
+
+    /**
+     * @brief Incremented whenever the unredirected set changes
+     */
+    unsigned long get_unredirect_serial() const { return unredirect_serial_; }
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    // Minimum time between frames (~60 Hz)
+    static constexpr std::chrono::milliseconds FRAME_INTERVAL{16};
+
+    struct TopLevel {
+        ::Window id = None;
+        int x = 0, y = 0;
+        int width = 0, height = 0;
+        int border_width = 0;
+        bool mapped = false;
+        bool input_only = false;
+        bool has_alpha = false;
+        XRenderPictFormat* format = nullptr;
+        Damage damage = None;
+        Picture picture = None;     // Created on first paint
+        Region shape = nullptr;     // Bounding shape relative to the window, if shaped
+        bool unredirected = false;
+    };
+
+    void add_toplevel(::Window id);
+    void remove_toplevel(::Window id, bool destroyed);
+    void restack(::Window id, ::Window above);
+    void map_toplevel(TopLevel& toplevel);
+    void unmap_toplevel(TopLevel& toplevel);
+    void damage_toplevel(const TopLevel& toplevel);
+    void damage_rect(int x, int y, int width, int height);
+    void update_shape(TopLevel& toplevel, bool shaped);
+    Region get_region(const TopLevel& toplevel) const;
+    TopLevel* find(::Window id);
+
+    bool paint();           // render() then present()
+    bool render();          // Damaged region into the back buffer; false if none
+    void present();         // Back buffer to the overlay, clearing the damage
+    void paint_toplevel(TopLevel& toplevel, Region clip, int op);
+
+    void update_unredirection();
+    void redirect_toplevel(TopLevel& toplevel);
+    void unredirect_toplevel(TopLevel& toplevel);
+    void reshape_overlay();
+
+    Display* display_;
+    int screen_;
+    ::Window root_;
+    int root_width_, root_height_;
+
+    bool active_;
+    int damage_event_base_;
+    int shape_event_base_;
+    ::Window overlay_;
+    Picture overlay_picture_;
+    Pixmap back_buffer_;
+    Picture back_picture_;
+    Picture background_;
+
+    std::unordered_map<::Window, TopLevel> toplevels_;
+    std::vector<::Window> stack_;   // Bottom to top
+
+    std::vector<XRectangle> outputs_;
+    std::vector<::Window> unredirected_;
+    std::vector<::Window> candidates_;
+    unsigned long unredirect_serial_;
+
+    Region damage_;                 // Accumulated since the last frame, root coordinates
+    std::chrono::steady_clock::time_point last_frame_;
+
+    // Scratch regions reused by every frame
+    Region remaining_;
+    std::vector<std::pair<TopLevel*, Region>> translucent_;
+
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_COMPOSITOR_H
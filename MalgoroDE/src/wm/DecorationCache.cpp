@@ -0,0 +1,48 @@
+#include "DecorationCache.h"
+
+namespace MalgoroDE {
+
+DecorationCache::DecorationCache(Display* display)
+    : display_(display)
+{
+}
+
+DecorationCache::~DecorationCache() {
+    for (auto& entry : pixmaps_) {
+        XFreePixmap(display_, entry.second);
+    }
+}
+
+Pixmap DecorationCache::find(uint64_t key) {
+    auto it = pixmaps_.find(key);
+    if (it == pixmaps_.end()) {
+        stats_.misses++;
+        return None;
+    }
+    stats_.hits++;
+    return it->second;
+}
+
+void DecorationCache::insert(uint64_t key, Pixmap pixmap) {
+    auto result = pixmaps_.emplace(key, pixmap);
+    if (!result.second) {
+        XFreePixmap(display_, result.first->second);
+        result.first->second = pixmap;
+    }
+    stats_.pixmaps = pixmaps_.size();
+}
+
+void DecorationCache::evict_other_themes(uint32_t theme) {
+    for (auto it = pixmaps_.begin(); it != pixmaps_.end();) {
+        bool shared = (it->first >> 56) == CORNER_MASK;
+        if (!shared && ((it->first >> 32) & 0xffffff) != (theme & 0xffffff)) {
+            XFreePixmap(display_, it->second);
+            it = pixmaps_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    stats_.pixmaps = pixmaps_.size();
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,74 @@
+#ifndef MALGORO_DECORATION_CACHE_H
+#define MALGORO_DECORATION_CACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <X11/Xlib.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Server-side pixmaps of pre-rendered decoration parts
+ *
+ * Entries are keyed by a packed 64-bit key (part, theme serial and two
+ * part-specific parameters), so a theme switch simply misses and never
+ * returns stale artwork. Pixmaps stay on the server; drawing a cached part
+ * is an XCopyArea or a tiled fill with no client-side rendering.
+ */
+class DecorationCache {
+public:
+    enum Part : uint8_t {
+        TITLEBAR_STRIP,     // 1 pixel wide, titlebar high; tiled across the width
+        BORDER_TILE,        // Border colour; tiled along every edge
+        BUTTON_SPRITE,      // One button in one state
+        CORNER_MASK         // 1-bit frame corner cut-out; shared by all themes
+    };
+
+    struct Stats {
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+        unsigned long pixmaps = 0;      // Currently cached
+    };
+
+    explicit DecorationCache(Display* display);
+    ~DecorationCache();
+
+    DecorationCache(const DecorationCache&) = delete;
+    DecorationCache& operator=(const DecorationCache&) = delete;
+
+    static uint64_t make_key(Part part, uint32_t theme, uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(part) << 56) |
+               (static_cast<uint64_t>(theme & 0xffffff) << 32) |
+               (static_cast<uint64_t>(a & 0xffff) << 16) |
+               static_cast<uint64_t>(b & 0xffff);
+    }
+
+    /**
+     * @brief Look up a cached pixmap
+     * @return None on a miss
+     */
+    Pixmap find(uint64_t key);
+
+    /**
+     * @brief Take ownership of a freshly rendered pixmap
+     */
+    void insert(uint64_t key, Pixmap pixmap);
+
+    /**
+     * @brief Free every pixmap rendered for themes other than @p theme
+     *
+     * Corner masks only depend on their radius and are kept.
+     */
+    void evict_other_themes(uint32_t theme);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    Display* display_;
+    std::unordered_map<uint64_t, Pixmap> pixmaps_;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_DECORATION_CACHE_H
@@ -0,0 +1,721 @@
+#include "Decorator.h"
+#include "Window.h"
+#include <X11/extensions/shape.h>
+#include <cairo/cairo-xlib.h>
+#include <pango/pangocairo.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+namespace MalgoroDE {
+
+namespace {
+
+// Pointer slack around the frame edges for starting a resize
+const int RESIZE_GRIP = 4;
+
+// Space between the title and the buttons on either side of it
+const int TITLE_PADDING = 4;
+
+// Built-in decoration colours, matching the ClassicThemes definitions
+struct BuiltinTheme {
+    const char* key;
+    unsigned int titlebar_active;
+    unsigned int titlebar_inactive;
+    unsigned int border;
+    unsigned int text_active;
+    unsigned int text_inactive;
+    bool gradient;
+    int corner_radius;      // Top corners; 0 for square frames
+};
+
+const BuiltinTheme builtin_themes[] = {
+    { "luna", 0x3A6EA5, 0x7A96DF, 0x0054E3, 0xFFFFFF, 0xD8E4F8, true, 7 },
+    { "classic", 0x0078D7, 0x999999, 0xACACAC, 0xFFFFFF, 0xE8E8E8, true, 0 },
+    { "royale", 0x4A5D89, 0x8A9DC9, 0x5A6D99, 0xFFFFFF, 0xE0E6F2, true, 7 },
+    { "olive", 0x748B4B, 0xA4BB8B, 0x7E9B5B, 0xFFFFFF, 0xEEF2E6, true, 7 },
+    { "silver", 0x9B9B9B, 0xCBCBCB, 0xABABAB, 0x000000, 0x555555, false, 0 },
+};
+
+const unsigned int CLOSE_BUTTON_COLOR = 0xE04343;
+
+template <typename Color>
+void set_rgb(Color& color, unsigned int rgb) {
+    color.r = ((rgb >> 16) & 0xff) / 255.0;
+    color.g = ((rgb >> 8) & 0xff) / 255.0;
+    color.b = (rgb & 0xff) / 255.0;
+}
+
+// Lighten towards white (amount > 0) or darken towards black (amount < 0)
+double shade(double value, double amount) {
+    return amount >= 0 ? value + (1.0 - value) * amount : value * (1.0 + amount);
+}
+
+template <typename Color>
+void set_source(cairo_t* cr, const Color& color, double amount = 0.0) {
+    cairo_set_source_rgb(cr, shade(color.r, amount), shade(color.g, amount), shade(color.b, amount));
+}
+
+template <typename Color>
+void add_stop(cairo_pattern_t* pattern, double offset, const Color& color, double amount) {
+    cairo_pattern_add_color_stop_rgb(pattern, offset,
+        shade(color.r, amount), shade(color.g, amount), shade(color.b, amount));
+}
+
+void rounded_rectangle(cairo_t* cr, double x, double y, double w, double h, double r) {
+    cairo_new_sub_path(cr);
+    cairo_arc(cr, x + w - r, y + r, r, -M_PI / 2, 0);
+    cairo_arc(cr, x + w - r, y + h - r, r, 0, M_PI / 2);
+    cairo_arc(cr, x + r, y + h - r, r, M_PI / 2, M_PI);
+    cairo_arc(cr, x + r, y + r, r, M_PI, 3 * M_PI / 2);
+    cairo_close_path(cr);
+}
+
+} // namespace
+
+Decorator::Decorator(Display* display)
+    : display_(display)
+    , root_(DefaultRootWindow(display))
+    , visual_(DefaultVisual(display, DefaultScreen(display)))
+    , depth_(DefaultDepth(display, DefaultScreen(display)))
+    , gc_(XCreateGC(display, DefaultRootWindow(display), 0, nullptr))
+    , shape_supported_(false)
+    , theme_serial_(0)
+    , titlebar_height_(24)
+    , border_width_(1)
+    , cache_(display)
+{
+    button_layout_ = {
+        { Button::MINIMIZE, ButtonPosition::RIGHT },
+        { Button::MAXIMIZE, ButtonPosition::RIGHT },
+        { Button::CLOSE, ButtonPosition::RIGHT },
+    };
+
+    int event_base, error_base;
+    shape_supported_ = XShapeQueryExtension(display_, &event_base, &error_base);
+
+    load_theme("luna");
+}
+
+Decorator::~Decorator() {
+    for (auto& entry : frames_) {
+        free_title_layers(entry.second);
+    }
+    XFreeGC(display_, gc_);
+}
+
+void Decorator::decorate_window(Window* window) {
+    if (!window || !window->get_frame()) {
+        return;
+    }
+    frames_[window->get_frame()];
+    draw(window, window->is_focused());
+}
+
+void Decorator::undecorate_window(Window* window) {
+    if (!window) {
+        return;
+    }
+    auto it = frames_.find(window->get_frame());
+    if (it != frames_.end()) {
+        // The frame is recycled for another window, which starts unshaped
+        if (it->second.shape_radius != 0) {
+            XShapeCombineMask(display_, window->get_frame(), ShapeBounding, 0, 0, None, ShapeSet);
+        }
+        free_title_layers(it->second);
+        frames_.erase(it);
+    }
+}
+
+void Decorator::set_window_active(Window* window, bool active) {
+    draw(window, active);
+}
+
+void Decorator::draw(Window* window, bool focused) {
+    if (!window || !window->get_frame()) {
+        return;
+    }
+
+    ::Window frame = window->get_frame();
+    FrameDecoration& decoration = frames_[frame];
+
+    int frame_x, frame_y, frame_width, frame_height;
+    window->get_frame_geometry(frame_x, frame_y, frame_width, frame_height);
+
+    update_shape(window, decoration);
+
+    // An undecorated fullscreen frame is entirely covered by its client
+    if (window->is_fullscreen()) {
+        return;
+    }
+
+    // Titlebar background and borders: one tiled fill each
+    fill_tiled(frame, get_titlebar_strip(focused), 0, 0, frame_width, titlebar_height_);
+
+    Pixmap border = get_border_tile(focused);
+    int side_height = frame_height - titlebar_height_;
+    fill_tiled(frame, border, 0, titlebar_height_, border_width_, side_height);
+    fill_tiled(frame, border, frame_width - border_width_, titlebar_height_, border_width_, side_height);
+    fill_tiled(frame, border, 0, frame_height - border_width_, frame_width, border_width_);
+
+    // Title layer, re-rendered only if the title or its width changed
+    int title_x, title_width;
+    get_title_area(frame_width, title_x, title_width);
+    if (title_width > 0) {
+        Pixmap layer = get_title_layer(window, decoration.title[focused], focused, title_width);
+        XCopyArea(display_, layer, frame, gc_, 0, 0, title_width, titlebar_height_, title_x, 0);
+    }
+
+    const HitTable& table = get_hit_table(window, decoration);
+    for (int i = 0; i < table.count; ++i) {
+        const HitRect& rect = table.rects[i];
+        if (rect.area == HIT_BUTTON) {
+            draw_button_sprite(window, decoration, static_cast<Button>(rect.value), focused);
+        }
+    }
+
+    stats_.draws++;
+}
+
+bool Decorator::handle_button_press(Window* window, int x, int y, unsigned int button) {
+    if (!window || button != Button1) {
+        return false;
+    }
+
+    switch (get_button_at(window, x, y)) {
+        case Button::CLOSE:
+            window->close();
+            return true;
+        case Button::MINIMIZE:
+            window->set_minimized(true);
+            return true;
+        case Button::SHADE:
+            window->set_shaded(!window->is_shaded());
+            return true;
+        case Button::MENU:
+            return true;
+        case Button::MAXIMIZE:
+        case Button::NONE:
+            break;
+    }
+    return false;
+}
+
+void Decorator::load_theme(const std::string& theme_name) {
+    std::string name = theme_name;
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+
+    // Accept both "luna" and "Malgoro Luna"; unknown names fall back to Luna
+    const BuiltinTheme* builtin = &builtin_themes[0];
+    for (const BuiltinTheme& candidate : builtin_themes) {
+        if (name.find(candidate.key) != std::string::npos) {
+            builtin = &candidate;
+            break;
+        }
+    }
+
+    set_rgb(theme_.titlebar_active, builtin->titlebar_active);
+    set_rgb(theme_.titlebar_inactive, builtin->titlebar_inactive);
+    set_rgb(theme_.border_active, builtin->border);
+    set_rgb(theme_.border_inactive, builtin->titlebar_inactive);
+    set_rgb(theme_.text_active, builtin->text_active);
+    set_rgb(theme_.text_inactive, builtin->text_inactive);
+    set_rgb(theme_.button_close, CLOSE_BUTTON_COLOR);
+    set_rgb(theme_.button_maximize, builtin->titlebar_active);
+    set_rgb(theme_.button_minimize, builtin->titlebar_active);
+
+    theme_.titlebar_height = 24;
+    theme_.border_width = 1;
+    theme_.button_size = 18;
+    theme_.button_spacing = 2;
+    theme_.icon_size = 16;
+    theme_.font_family = "Sans";
+    theme_.font_size = 10;
+    theme_.font_bold = true;
+    theme_.gradient_titlebar = builtin->gradient;
+    theme_.rounded_corners = builtin->corner_radius > 0;
+    theme_.corner_radius = builtin->corner_radius;
+
+    titlebar_height_ = theme_.titlebar_height;
+    border_width_ = theme_.border_width;
+
+    // Every cached part is keyed by the serial, so the old theme's
+    // artwork can simply be dropped
+    theme_serial_++;
+    cache_.evict_other_themes(theme_serial_);
+}
+
+void Decorator::handle_motion(Window* window, int x, int y) {
+    if (!window || !window->get_frame()) {
+        return;
+    }
+
+    FrameDecoration& decoration = frames_[window->get_frame()];
+    Button hover = get_button_at(window, x, y);
+    if (hover == decoration.hover) {
+        return;
+    }
+
+    Button previous = decoration.hover;
+    decoration.hover = hover;
+    bool focused = window->is_focused();
+    if (previous != Button::NONE) {
+        draw_button_sprite(window, decoration, previous, focused);
+    }
+    if (hover != Button::NONE) {
+        draw_button_sprite(window, decoration, hover, focused);
+    }
+}
+
+void Decorator::handle_leave(Window* window) {
+    handle_motion(window, -1, -1);
+}
+
+bool Decorator::is_in_titlebar(Window* window, int x, int y) {
+    return hit_test(window, x, y).area == HIT_TITLEBAR;
+}
+
+bool Decorator::is_on_border(Window* window, int x, int y, int& border_mask) {
+    const HitRect& hit = hit_test(window, x, y);
+    border_mask = hit.area == HIT_BORDER ? hit.value : 0;
+    return border_mask != BORDER_NONE;
+}
+
+Decorator::Button Decorator::get_button_at(Window* window, int x, int y) {
+    const HitRect& hit = hit_test(window, x, y);
+    return hit.area == HIT_BUTTON ? static_cast<Button>(hit.value) : Button::NONE;
+}
+
+const Decorator::HitRect& Decorator::hit_test(Window* window, int x, int y) {
+    static const HitRect nothing;
+
+    const HitTable& table = get_hit_table(window, frames_[window->get_frame()]);
+    for (int i = 0; i < table.count; ++i) {
+        const HitRect& rect = table.rects[i];
+        // Unsigned compares fold both bounds of an axis into one test
+        if ((static_cast<unsigned>(x - rect.x) < rect.width) &
+            (static_cast<unsigned>(y - rect.y) < rect.height)) {
+            return rect;
+        }
+    }
+    return nothing;
+}
+
+const Decorator::HitTable& Decorator::get_hit_table(Window* window, FrameDecoration& decoration) {
+    int frame_x, frame_y, frame_width, frame_height;
+    window->get_frame_geometry(frame_x, frame_y, frame_width, frame_height);
+
+    HitTable& table = decoration.hits;
+    if (table.width != frame_width || table.height != frame_height || table.theme != theme_serial_) {
+        build_hit_table(table, frame_width, frame_height);
+        table.width = frame_width;
+        table.height = frame_height;
+        table.theme = theme_serial_;
+    }
+    return table;
+}
+
+void Decorator::build_hit_table(HitTable& table, int frame_width, int frame_height) const {
+    table.count = 0;
+    auto add = [&table](int x, int y, int w, int h, HitArea area, uint8_t value) {
+        if (w > 0 && h > 0 && table.count < MAX_HIT_RECTS) {
+            HitRect& rect = table.rects[table.count++];
+            rect.x = x;
+            rect.y = y;
+            rect.width = w;
+            rect.height = h;
+            rect.area = area;
+            rect.value = value;
+        }
+    };
+
+    // Resize zones: corners before edges so they win where both apply
+    int grip = std::max(border_width_, RESIZE_GRIP);
+    int right = frame_width - grip;
+    int bottom = frame_height - grip;
+    add(0, 0, grip, grip, HIT_BORDER, BORDER_TOP_LEFT);
+    add(right, 0, grip, grip, HIT_BORDER, BORDER_TOP_RIGHT);
+    add(0, bottom, grip, grip, HIT_BORDER, BORDER_BOTTOM_LEFT);
+    add(right, bottom, grip, grip, HIT_BORDER, BORDER_BOTTOM_RIGHT);
+    add(grip, 0, frame_width - 2 * grip, grip, HIT_BORDER, BORDER_TOP);
+    add(grip, bottom, frame_width - 2 * grip, grip, HIT_BORDER, BORDER_BOTTOM);
+    add(0, grip, grip, frame_height - 2 * grip, HIT_BORDER, BORDER_LEFT);
+    add(right, grip, grip, frame_height - 2 * grip, HIT_BORDER, BORDER_RIGHT);
+
+    for (const ButtonLayout& layout : button_layout_) {
+        int x, y, w, h;
+        get_button_rect(frame_width, layout.button, x, y, w, h);
+        add(x, y, w, h, HIT_BUTTON, static_cast<uint8_t>(layout.button));
+    }
+
+    add(0, 0, frame_width, titlebar_height_, HIT_TITLEBAR, 0);
+}
+
+void Decorator::draw_button_sprite(Window* window, const FrameDecoration& decoration,
+                                   Button button, bool focused) {
+    int x, y, w, h;
+    get_button_rect(decoration.hits.width, button, x, y, w, h);
+    if (w <= 0) {
+        return;
+    }
+
+    ButtonState state = button == decoration.hover ? ButtonState::HOVER : ButtonState::NORMAL;
+    Pixmap sprite = get_button_sprite(button, state, focused);
+    XCopyArea(display_, sprite, window->get_frame(), gc_, 0, 0, w, h, x, y);
+}
+
+void Decorator::get_button_rect(int frame_width, Button button, int& x, int& y, int& w, int& h) const {
+    int size = theme_.button_size;
+    int spacing = theme_.button_spacing;
+    y = (titlebar_height_ - size) / 2;
+    w = h = size;
+
+    // Left buttons run left to right, right buttons are packed against the
+    // right edge in layout order
+    int left = border_width_ + spacing;
+    int right = frame_width - border_width_ - spacing;
+    for (auto it = button_layout_.rbegin(); it != button_layout_.rend(); ++it) {
+        if (it->position == ButtonPosition::RIGHT) {
+            right -= size;
+            if (it->button == button) {
+                x = right;
+                return;
+            }
+            right -= spacing;
+        }
+    }
+    for (const ButtonLayout& layout : button_layout_) {
+        if (layout.position == ButtonPosition::LEFT) {
+            if (layout.button == button) {
+                x = left;
+                return;
+            }
+            left += size + spacing;
+        }
+    }
+
+    x = y = w = h = 0;
+}
+
+void Decorator::get_title_area(int frame_width, int& x, int& width) const {
+    int left = border_width_ + theme_.button_spacing;
+    int right = frame_width - border_width_ - theme_.button_spacing;
+    for (const ButtonLayout& layout : button_layout_) {
+        if (layout.position == ButtonPosition::LEFT) {
+            left += theme_.button_size + theme_.button_spacing;
+        } else {
+            right -= theme_.button_size + theme_.button_spacing;
+        }
+    }
+
+    x = left + TITLE_PADDING;
+    width = right - TITLE_PADDING - x;
+}
+
+Pixmap Decorator::get_titlebar_strip(bool focused) {
+    uint64_t key = DecorationCache::make_key(DecorationCache::TITLEBAR_STRIP,
+        theme_serial_, focused, titlebar_height_);
+    Pixmap pixmap = cache_.find(key);
+    if (pixmap != None) {
+        return pixmap;
+    }
+
+    // The gradient only varies vertically, so one column tiles the titlebar
+    pixmap = XCreatePixmap(display_, root_, 1, titlebar_height_, depth_);
+    cairo_t* cr = begin_render(pixmap, 1, titlebar_height_);
+    draw_titlebar(cr, 1, titlebar_height_, focused);
+    end_render(cr);
+
+    cache_.insert(key, pixmap);
+    return pixmap;
+}
+
+Pixmap Decorator::get_border_tile(bool focused) {
+    int size = std::max(border_width_, 1);
+    uint64_t key = DecorationCache::make_key(DecorationCache::BORDER_TILE,
+        theme_serial_, focused, size);
+    Pixmap pixmap = cache_.find(key);
+    if (pixmap != None) {
+        return pixmap;
+    }
+
+    pixmap = XCreatePixmap(display_, root_, size, size, depth_);
+    cairo_t* cr = begin_render(pixmap, size, size);
+    draw_border(cr, size, size, focused);
+    end_render(cr);
+
+    cache_.insert(key, pixmap);
+    return pixmap;
+}
+
+Pixmap Decorator::get_button_sprite(Button button, ButtonState state, bool focused) {
+    uint64_t key = DecorationCache::make_key(DecorationCache::BUTTON_SPRITE, theme_serial_,
+        static_cast<uint32_t>(button), (static_cast<uint32_t>(state) << 1) | focused);
+    Pixmap pixmap = cache_.find(key);
+    if (pixmap != None) {
+        return pixmap;
+    }
+
+    // Sprites carry their own slice of the titlebar so they copy opaquely
+    int size = theme_.button_size;
+    int offset = (titlebar_height_ - size) / 2;
+    pixmap = XCreatePixmap(display_, root_, size, size, depth_);
+    XSetTSOrigin(display_, gc_, 0, -offset);
+    fill_tiled(pixmap, get_titlebar_strip(focused), 0, 0, size, size);
+    XSetTSOrigin(display_, gc_, 0, 0);
+
+    cairo_t* cr = begin_render(pixmap, size, size);
+    draw_button(cr, button, state, focused);
+    end_render(cr);
+
+    cache_.insert(key, pixmap);
+    return pixmap;
+}
+
+Pixmap Decorator::get_title_layer(Window* window, TitleLayer& layer, bool focused, int width) {
+    const std::string& title = window->get_visible_title();
+    if (layer.pixmap != None && layer.width == width &&
+        layer.theme == theme_serial_ && layer.title == title) {
+        stats_.title_reuses++;
+        return layer.pixmap;
+    }
+
+    if (layer.pixmap != None && layer.width != width) {
+        XFreePixmap(display_, layer.pixmap);
+        layer.pixmap = None;
+    }
+    if (layer.pixmap == None) {
+        layer.pixmap = XCreatePixmap(display_, root_, width, titlebar_height_, depth_);
+    }
+
+    // Same background as the surrounding titlebar, then the text
+    fill_tiled(layer.pixmap, get_titlebar_strip(focused), 0, 0, width, titlebar_height_);
+    cairo_t* cr = begin_render(layer.pixmap, width, titlebar_height_);
+    draw_title_text(cr, title, width, focused);
+    end_render(cr);
+
+    layer.width = width;
+    layer.theme = theme_serial_;
+    layer.title = title;
+    stats_.title_renders++;
+    return layer.pixmap;
+}
+
+cairo_t* Decorator::begin_render(Pixmap pixmap, int width, int height) {
+    cairo_surface_t* surface = cairo_xlib_surface_create(display_, pixmap, visual_, width, height);
+    cairo_t* cr = cairo_create(surface);
+    cairo_surface_destroy(surface);     // Held by the context
+    return cr;
+}
+
+void Decorator::end_render(cairo_t* cr) {
+    cairo_surface_flush(cairo_get_target(cr));
+    cairo_destroy(cr);
+}
+
+void Decorator::draw_titlebar(cairo_t* cr, int width, int height, bool focused) {
+    auto& color = focused ? theme_.titlebar_active : theme_.titlebar_inactive;
+
+    if (theme_.gradient_titlebar) {
+        cairo_pattern_t* gradient = cairo_pattern_create_linear(0, 0, 0, height);
+        add_stop(gradient, 0.0, color, 0.35);
+        add_stop(gradient, 0.5, color, 0.0);
+        add_stop(gradient, 1.0, color, -0.15);
+        cairo_set_source(cr, gradient);
+        cairo_pattern_destroy(gradient);
+    } else {
+        set_source(cr, color);
+    }
+
+    cairo_rectangle(cr, 0, 0, width, height);
+    cairo_fill(cr);
+}
+
+void Decorator::draw_border(cairo_t* cr, int width, int height, bool focused) {
+    set_source(cr, focused ? theme_.border_active : theme_.border_inactive);
+    cairo_rectangle(cr, 0, 0, width, height);
+    cairo_fill(cr);
+}
+
+void Decorator::draw_button(cairo_t* cr, Button button, ButtonState state, bool focused) {
+    double size = theme_.button_size;
+    double amount = state == ButtonState::HOVER ? 0.2 : state == ButtonState::PRESSED ? -0.2 : 0.0;
+    if (!focused) {
+        amount += 0.4;
+    }
+
+    rounded_rectangle(cr, 0.5, 0.5, size - 1, size - 1, 3);
+    if (button == Button::CLOSE) {
+        set_source(cr, theme_.button_close, amount);
+    } else if (button == Button::MAXIMIZE) {
+        set_source(cr, theme_.button_maximize, amount + 0.15);
+    } else if (button == Button::MINIMIZE) {
+        set_source(cr, theme_.button_minimize, amount + 0.15);
+    } else {
+        set_source(cr, theme_.titlebar_active, amount + 0.15);
+    }
+    cairo_fill_preserve(cr);
+    cairo_set_source_rgba(cr, 1, 1, 1, 0.6);
+    cairo_set_line_width(cr, 1);
+    cairo_stroke(cr);
+
+    // Glyph
+    double inset = size * 0.3;
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_set_line_width(cr, 2);
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
+    switch (button) {
+        case Button::CLOSE:
+            cairo_move_to(cr, inset, inset);
+            cairo_line_to(cr, size - inset, size - inset);
+            cairo_move_to(cr, size - inset, inset);
+            cairo_line_to(cr, inset, size - inset);
+            break;
+        case Button::MAXIMIZE:
+            cairo_rectangle(cr, inset, inset, size - 2 * inset, size - 2 * inset);
+            break;
+        case Button::MINIMIZE:
+            cairo_move_to(cr, inset, size - inset);
+            cairo_line_to(cr, size - inset, size - inset);
+            break;
+        case Button::SHADE:
+            cairo_move_to(cr, inset, size / 2 + 2);
+            cairo_line_to(cr, size / 2, inset + 2);
+            cairo_line_to(cr, size - inset, size / 2 + 2);
+            break;
+        case Button::MENU:
+            for (int i = 0; i < 3; ++i) {
+                cairo_move_to(cr, inset, inset + i * (size - 2 * inset) / 2);
+                cairo_line_to(cr, size - inset, inset + i * (size - 2 * inset) / 2);
+            }
+            break;
+        case Button::NONE:
+            break;
+    }
+    cairo_stroke(cr);
+}
+
+void Decorator::draw_title_text(cairo_t* cr, const std::string& title, int width, bool focused) {
+    int text_height;
+    PangoLayout* layout = layouts_.get(title, theme_.font_family, theme_.font_size,
+        theme_.font_bold, width, text_height);
+
+    cairo_move_to(cr, 0, (titlebar_height_ - text_height) / 2);
+    set_source(cr, focused ? theme_.text_active : theme_.text_inactive);
+    pango_cairo_show_layout(cr, layout);
+}
+
+void Decorator::update_shape(Window* window, FrameDecoration& decoration) {
+    if (!shape_supported_) {
+        return;
+    }
+
+    // Maximized and fullscreen frames meet the screen edges square
+    int radius = 0;
+    if (theme_.rounded_corners && !window->is_maximized() && !window->is_fullscreen()) {
+        radius = theme_.corner_radius;
+    }
+
+    int frame_x, frame_y, width, height;
+    window->get_frame_geometry(frame_x, frame_y, width, height);
+    radius = std::min(radius, std::min(width / 2, titlebar_height_));
+
+    if (radius == decoration.shape_radius &&
+        width == decoration.shape_width && height == decoration.shape_height) {
+        return;
+    }
+
+    ::Window frame = window->get_frame();
+    if (radius == 0) {
+        if (decoration.shape_radius != 0) {
+            XShapeCombineMask(display_, frame, ShapeBounding, 0, 0, None, ShapeSet);
+            stats_.shape_sets++;
+        }
+    } else if (radius != decoration.shape_radius) {
+        XRectangle rect = { 0, 0, static_cast<unsigned short>(width), static_cast<unsigned short>(height) };
+        XShapeCombineRectangles(display_, frame, ShapeBounding, 0, 0, &rect, 1, ShapeSet, YXBanded);
+        XShapeCombineMask(display_, frame, ShapeBounding, 0, 0,
+            get_corner_mask(radius, false), ShapeSubtract);
+        XShapeCombineMask(display_, frame, ShapeBounding, width - radius, 0,
+            get_corner_mask(radius, true), ShapeSubtract);
+        stats_.shape_sets++;
+    } else {
+        // The shape does not follow resizes, but only the right corner and
+        // newly uncovered strips differ; whatever lies outside the frame is
+        // clipped by the server, so shrinking needs nothing
+        if (width != decoration.shape_width) {
+            XRectangle strip;
+            strip.x = std::min(width, decoration.shape_width) - radius;
+            strip.y = 0;
+            strip.width = std::abs(width - decoration.shape_width) + radius;
+            strip.height = std::max(height, decoration.shape_height);
+            XShapeCombineRectangles(display_, frame, ShapeBounding, 0, 0, &strip, 1, ShapeUnion, YXBanded);
+            XShapeCombineMask(display_, frame, ShapeBounding, width - radius, 0,
+                get_corner_mask(radius, true), ShapeSubtract);
+        }
+        if (height > decoration.shape_height) {
+            XRectangle strip;
+            strip.x = 0;
+            strip.y = decoration.shape_height;
+            strip.width = width;
+            strip.height = height - decoration.shape_height;
+            XShapeCombineRectangles(display_, frame, ShapeBounding, 0, 0, &strip, 1, ShapeUnion, YXBanded);
+        }
+        stats_.shape_updates++;
+    }
+
+    decoration.shape_width = width;
+    decoration.shape_height = height;
+    decoration.shape_radius = radius;
+}
+
+Pixmap Decorator::get_corner_mask(int radius, bool right) {
+    uint64_t key = DecorationCache::make_key(DecorationCache::CORNER_MASK, 0, radius, right);
+    Pixmap mask = cache_.find(key);
+    if (mask != None) {
+        return mask;
+    }
+
+    // Set bits mark the pixels outside the arc, which are cut away
+    mask = XCreatePixmap(display_, root_, radius, radius, 1);
+    GC gc = XCreateGC(display_, mask, 0, nullptr);
+    XSetForeground(display_, gc, 0);
+    XFillRectangle(display_, mask, gc, 0, 0, radius, radius);
+    XSetForeground(display_, gc, 1);
+    for (int y = 0; y < radius; ++y) {
+        double dy = radius - (y + 0.5);
+        int inside = static_cast<int>(std::ceil(radius - std::sqrt(radius * radius - dy * dy) - 0.5));
+        if (inside > 0) {
+            XFillRectangle(display_, mask, gc, right ? radius - inside : 0, y, inside, 1);
+        }
+    }
+    XFreeGC(display_, gc);
+
+    cache_.insert(key, mask);
+    return mask;
+}
+
+void Decorator::fill_tiled(Drawable drawable, Pixmap tile, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    XGCValues values;
+    values.fill_style = FillTiled;
+    values.tile = tile;
+    XChangeGC(display_, gc_, GCFillStyle | GCTile, &values);
+    XFillRectangle(display_, drawable, gc_, x, y, width, height);
+}
+
+void Decorator::free_title_layers(FrameDecoration& decoration) {
+    for (TitleLayer& layer : decoration.title) {
+        if (layer.pixmap != None) {
+            XFreePixmap(display_, layer.pixmap);
+            layer.pixmap = None;
+        }
+    }
+}
+
+} // namespace MalgoroDE
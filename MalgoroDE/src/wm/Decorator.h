@@ -1,10 +1,14 @@
 #ifndef MALGORO_DECORATOR_H
 #define MALGORO_DECORATOR_H
 
+#include <cstdint>
 #include <string>
-#include <memory>
+#include <unordered_map>
+#include <vector>
 #include <X11/Xlib.h>
 #include <cairo/cairo.h>
+#include "DecorationCache.h"
+#include "TitleLayoutCache.h"
 
 namespace MalgoroDE {
 
@@ -12,28 +16,84 @@ class Window;
 
 /**
  * @brief Window decoration renderer (titlebars, borders, buttons)
+ *
+ * Decorations are assembled on the server from cached pixmaps: a tiled
+ * titlebar strip, a border tile, button sprites, and a per-window title
+ * layer that is only re-rendered when the title or its width changes.
+ * Redrawing a frame (focus change, expose) issues a handful of tiled
+ * fills and XCopyArea calls and no cairo work.
+ *
+ * Themes with rounded corners shape the frame's bounding region through
+ * the X Shape extension, cutting shared 1-bit corner masks out of it, so
+ * rounded frames need no compositor.
  */
 class Decorator {
 public:
     Decorator(Display* display);
     ~Decorator();
 
+    /**
+     * @brief Start decorating a newly framed window
+     */
+    void decorate_window(Window* window);
+
+    /**
+     * @brief Release decoration resources for a window
+     */
+    void undecorate_window(Window* window);
+
+    /**
+     * @brief Redraw decorations for a focus change
+     */
+    void set_window_active(Window* window, bool active);
+
     /**
      * @brief Draw window decorations
      */
-    void draw(std::shared_ptr<Window> window, bool focused);
+    void draw(Window* window, bool focused);
 
     /**
      * @brief Handle button click on decoration
+     *
+     * Maximize depends on the window's output and is left to the caller.
      * @return true if click was on decoration button
      */
-    bool handle_button_press(std::shared_ptr<Window> window, int x, int y, unsigned int button);
+    bool handle_button_press(Window* window, int x, int y, unsigned int button);
+
+    /**
+     * @brief Update button hover state for pointer motion over a frame
+     *
+     * Only buttons whose hover state changed are redrawn.
+     */
+    void handle_motion(Window* window, int x, int y);
+
+    /**
+     * @brief Clear hover state when the pointer leaves a frame
+     */
+    void handle_leave(Window* window);
 
     /**
      * @brief Load theme
      */
     void load_theme(const std::string& theme_name);
 
+    /**
+     * @brief Decoration rendering counters
+     *
+     * Title renders happen only when a title, its width or the theme
+     * changed; every other draw reuses the cached layer.
+     */
+    struct Stats {
+        unsigned long draws = 0;
+        unsigned long title_renders = 0;
+        unsigned long title_reuses = 0;
+        unsigned long shape_sets = 0;       // Whole bounding shape rebuilt
+        unsigned long shape_updates = 0;    // Only the changed edges reshaped
+    };
+    const Stats& get_stats() const { return stats_; }
+    const DecorationCache::Stats& get_cache_stats() const { return cache_.get_stats(); }
+    const TitleLayoutCache::Stats& get_layout_stats() const { return layouts_.get_stats(); }
+
     /**
      * @brief Get titlebar height for theme
      */
@@ -47,12 +107,27 @@ public:
     /**
      * @brief Check if position is in titlebar
      */
-    bool is_in_titlebar(std::shared_ptr<Window> window, int x, int y) const;
+    bool is_in_titlebar(Window* window, int x, int y);
 
     /**
      * @brief Check if position is on resize border
      */
-    bool is_on_border(std::shared_ptr<Window> window, int x, int y, int& border_mask) const;
+    bool is_on_border(Window* window, int x, int y, int& border_mask);
+
+    // Titlebar buttons
+    enum class Button {
+        NONE,
+        CLOSE,
+        MAXIMIZE,
+        MINIMIZE,
+        MENU,
+        SHADE
+    };
+
+    /**
+     * @brief Titlebar button at a frame position, or Button::NONE
+     */
+    Button get_button_at(Window* window, int x, int y);
 
     // Border masks
     enum BorderMask {
@@ -68,24 +143,90 @@ public:
     };
 
 private:
-    void draw_titlebar(cairo_t* cr, std::shared_ptr<Window> window, bool focused);
-    void draw_border(cairo_t* cr, std::shared_ptr<Window> window, bool focused);
-    void draw_buttons(cairo_t* cr, std::shared_ptr<Window> window, bool focused);
-    void draw_title_text(cairo_t* cr, std::shared_ptr<Window> window, bool focused);
-    void draw_icon(cairo_t* cr, std::shared_ptr<Window> window);
+    enum class ButtonState {
+        NORMAL,
+        HOVER,
+        PRESSED
+    };
 
-    // Button detection
-    enum class Button {
-        NONE,
-        CLOSE,
-        MAXIMIZE,
-        MINIMIZE,
-        MENU,
-        SHADE
+    // Per-focus-state title layer of one frame
+    struct TitleLayer {
+        Pixmap pixmap = None;
+        int width = 0;
+        uint32_t theme = 0;
+        std::string title;
+    };
+
+    // Hit-test table of one frame, in priority order: the eight resize
+    // zones, the buttons, then the titlebar. Rebuilt when the frame size
+    // or the theme changes.
+    enum HitArea : uint8_t {
+        HIT_NOTHING,
+        HIT_BORDER,
+        HIT_BUTTON,
+        HIT_TITLEBAR
+    };
+
+    struct HitRect {
+        int16_t x = 0;
+        int16_t y = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        HitArea area = HIT_NOTHING;
+        uint8_t value = 0;      // BorderMask or Button
+    };
+
+    static const int MAX_HIT_RECTS = 16;
+
+    struct HitTable {
+        int width = -1;
+        int height = -1;
+        uint32_t theme = 0;
+        int count = 0;
+        HitRect rects[MAX_HIT_RECTS];
+    };
+
+    struct FrameDecoration {
+        TitleLayer title[2];    // Indexed by focused
+        HitTable hits;
+        Button hover = Button::NONE;
+
+        // Bounding shape last applied to the frame
+        int shape_width = -1;
+        int shape_height = -1;
+        int shape_radius = 0;
     };
 
-    Button get_button_at(std::shared_ptr<Window> window, int x, int y) const;
-    void get_button_rect(std::shared_ptr<Window> window, Button button, int& x, int& y, int& w, int& h) const;
+    // Cached parts, rendered on a miss
+    Pixmap get_titlebar_strip(bool focused);
+    Pixmap get_border_tile(bool focused);
+    Pixmap get_button_sprite(Button button, ButtonState state, bool focused);
+    Pixmap get_title_layer(Window* window, TitleLayer& layer, bool focused, int width);
+
+    // Cairo rendering into a new pixmap
+    cairo_t* begin_render(Pixmap pixmap, int width, int height);
+    void end_render(cairo_t* cr);
+    void draw_titlebar(cairo_t* cr, int width, int height, bool focused);
+    void draw_border(cairo_t* cr, int width, int height, bool focused);
+    void draw_button(cairo_t* cr, Button button, ButtonState state, bool focused);
+    void draw_title_text(cairo_t* cr, const std::string& title, int width, bool focused);
+
+    // Rounded corners
+    void update_shape(Window* window, FrameDecoration& decoration);
+    Pixmap get_corner_mask(int radius, bool right);
+
+    void fill_tiled(Drawable drawable, Pixmap tile, int x, int y, int width, int height);
+    void get_title_area(int frame_width, int& x, int& width) const;
+    void free_title_layers(FrameDecoration& decoration);
+
+    // Hit testing
+    const HitTable& get_hit_table(Window* window, FrameDecoration& decoration);
+    void build_hit_table(HitTable& table, int frame_width, int frame_height) const;
+    const HitRect& hit_test(Window* window, int x, int y);
+    void draw_button_sprite(Window* window, const FrameDecoration& decoration,
+                            Button button, bool focused);
+
+    void get_button_rect(int frame_width, Button button, int& x, int& y, int& w, int& h) const;
 
     // Theme data
     struct Theme {
@@ -125,10 +266,22 @@ private:
     };
 
     Display* display_;
+    ::Window root_;
+    Visual* visual_;
+    int depth_;
+    GC gc_;
+    bool shape_supported_;
+
     Theme theme_;
+    uint32_t theme_serial_;     // Bumped by load_theme(); part of every cache key
     int titlebar_height_;
     int border_width_;
 
+    DecorationCache cache_;
+    TitleLayoutCache layouts_;      // Shaped titles, shared by both focus states
+    std::unordered_map<::Window, FrameDecoration> frames_;     // By frame ID
+    Stats stats_;
+
     // Button layout
     enum class ButtonPosition {
         LEFT,
@@ -0,0 +1,199 @@
+#include "EdgeIndex.h"
+#include "Window.h"
+#include "WindowStore.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace MalgoroDE {
+
+void EdgeIndex::add_edge(std::vector<Edge>& edges, const Edge& edge) {
+    auto at = std::upper_bound(edges.begin(), edges.end(), edge.position,
+        [](int position, const Edge& other) { return position < other.position; });
+    edges.insert(at, edge);
+}
+
+void EdgeIndex::remove_edge(std::vector<Edge>& edges, int position, WindowHandle owner) {
+    auto it = std::lower_bound(edges.begin(), edges.end(), position,
+        [](const Edge& edge, int value) { return edge.position < value; });
+    for (; it != edges.end() && it->position == position; ++it) {
+        if (it->owner == owner) {
+            edges.erase(it);
+            return;
+        }
+    }
+}
+
+EdgeIndex::Entry* EdgeIndex::find(const Window& window) {
+    WindowHandle handle = window.get_handle();
+    if (!handle.is_valid() || handle.index >= entries_.size() ||
+        !(entries_[handle.index].handle == handle)) {
+        return nullptr;
+    }
+    return &entries_[handle.index];
+}
+
+EdgeIndex::Edges& EdgeIndex::edges_for(int workspace) {
+    if (workspace >= static_cast<int>(workspaces_.size())) {
+        workspaces_.resize(workspace + 1);
+    }
+    return workspaces_[workspace];
+}
+
+void EdgeIndex::link(const Entry& entry) {
+    if (entry.workspace < 0) {
+        return;
+    }
+    const Layout::Rect& rect = entry.rect;
+    Edges& edges = edges_for(entry.workspace);
+    add_edge(edges.vertical, Edge{ rect.x, rect.y, rect.y + rect.height, entry.handle });
+    add_edge(edges.vertical, Edge{ rect.x + rect.width, rect.y, rect.y + rect.height, entry.handle });
+    add_edge(edges.horizontal, Edge{ rect.y, rect.x, rect.x + rect.width, entry.handle });
+    add_edge(edges.horizontal, Edge{ rect.y + rect.height, rect.x, rect.x + rect.width, entry.handle });
+}
+
+void EdgeIndex::unlink(const Entry& entry) {
+    if (entry.workspace < 0 || entry.workspace >= static_cast<int>(workspaces_.size())) {
+        return;
+    }
+    const Layout::Rect& rect = entry.rect;
+    Edges& edges = workspaces_[entry.workspace];
+    remove_edge(edges.vertical, rect.x, entry.handle);
+    remove_edge(edges.vertical, rect.x + rect.width, entry.handle);
+    remove_edge(edges.horizontal, rect.y, entry.handle);
+    remove_edge(edges.horizontal, rect.y + rect.height, entry.handle);
+}
+
+void EdgeIndex::insert(const Window& window, int workspace, const Layout::Rect& frame) {
+    WindowHandle handle = window.get_handle();
+    if (!handle.is_valid()) {
+        return;
+    }
+    if (handle.index >= entries_.size()) {
+        entries_.resize(handle.index + 1);
+    }
+
+    Entry& entry = entries_[handle.index];
+    if (entry.handle.is_valid()) {
+        unlink(entry);
+    }
+    entry.handle = handle;
+    entry.workspace = workspace;
+    entry.rect = frame;
+    link(entry);
+}
+
+void EdgeIndex::update(const Window& window, const Layout::Rect& frame) {
+    Entry* entry = find(window);
+    if (!entry || entry->rect == frame) {
+        return;
+    }
+    unlink(*entry);
+    entry->rect = frame;
+    link(*entry);
+    stats_.updates++;
+}
+
+void EdgeIndex::set_workspace(const Window& window, int workspace) {
+    Entry* entry = find(window);
+    if (!entry || entry->workspace == workspace) {
+        return;
+    }
+    unlink(*entry);
+    entry->workspace = workspace;
+    link(*entry);
+}
+
+void EdgeIndex::remove(const Window& window) {
+    Entry* entry = find(window);
+    if (!entry) {
+        return;
+    }
+    unlink(*entry);
+    entry->handle = WindowHandle();
+    entry->workspace = -1;
+}
+
+void EdgeIndex::set_bounds(const std::vector<Layout::Rect>& areas) {
+    bounds_.vertical.clear();
+    bounds_.horizontal.clear();
+    for (const Layout::Rect& area : areas) {
+        add_edge(bounds_.vertical, Edge{ area.x, area.y, area.y + area.height, WindowHandle() });
+        add_edge(bounds_.vertical, Edge{ area.x + area.width, area.y, area.y + area.height, WindowHandle() });
+        add_edge(bounds_.horizontal, Edge{ area.y, area.x, area.x + area.width, WindowHandle() });
+        add_edge(bounds_.horizontal, Edge{ area.y + area.height, area.x, area.x + area.width, WindowHandle() });
+    }
+}
+
+bool EdgeIndex::closest(WindowStore& store, const std::vector<Edge>& edges, WindowHandle self,
+                        int position, int start, int end, int& distance, int& found) {
+    bool closer = false;
+    auto it = std::lower_bound(edges.begin(), edges.end(), position - SNAP_DISTANCE,
+        [](const Edge& edge, int value) { return edge.position < value; });
+    for (; it != edges.end() && it->position <= position + SNAP_DISTANCE; ++it) {
+        stats_.probes++;
+        // Only edges alongside the frame count
+        if (it->owner == self || it->start >= end || start >= it->end) {
+            continue;
+        }
+        int offset = std::abs(it->position - position);
+        if (offset >= distance) {
+            continue;
+        }
+        if (it->owner.is_valid()) {
+            Window* other = store.get(it->owner);
+            if (!other || other->is_minimized() || other->is_hidden()) {
+                continue;
+            }
+        }
+        distance = offset;
+        found = it->position;
+        closer = true;
+    }
+    return closer;
+}
+
+void EdgeIndex::snap(WindowStore& store, const Window& window, int& x, int& y) {
+    stats_.checks++;
+
+    int current_x, current_y, width, height;
+    window.get_frame_geometry(current_x, current_y, width, height);
+    WindowHandle self = window.get_handle();
+
+    const Edges* sets[2] = { &bounds_, nullptr };
+    int workspace = window.get_workspace();
+    if (workspace >= 0 && workspace < static_cast<int>(workspaces_.size())) {
+        sets[1] = &workspaces_[workspace];
+    }
+
+    // Either side of the frame may snap; the closest edge wins
+    int snapped_x = x;
+    int snapped_y = y;
+    int distance_x = SNAP_DISTANCE + 1;
+    int distance_y = SNAP_DISTANCE + 1;
+    for (const Edges* edges : sets) {
+        if (!edges) {
+            continue;
+        }
+        int found;
+        if (closest(store, edges->vertical, self, x, y, y + height, distance_x, found)) {
+            snapped_x = found;
+        }
+        if (closest(store, edges->vertical, self, x + width, y, y + height, distance_x, found)) {
+            snapped_x = found - width;
+        }
+        if (closest(store, edges->horizontal, self, y, x, x + width, distance_y, found)) {
+            snapped_y = found;
+        }
+        if (closest(store, edges->horizontal, self, y + height, x, x + width, distance_y, found)) {
+            snapped_y = found - height;
+        }
+    }
+
+    if (snapped_x != x || snapped_y != y) {
+        stats_.snapped++;
+    }
+    x = snapped_x;
+    y = snapped_y;
+}
+
+} // namespace MalgoroDE
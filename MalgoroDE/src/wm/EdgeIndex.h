@@ -0,0 +1,99 @@
+#ifndef MALGORO_EDGE_INDEX_H
+#define MALGORO_EDGE_INDEX_H
+
+#include <vector>
+#include "Layout.h"
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+class Window;
+class WindowStore;
+
+/**
+ * @brief Sorted frame edges for snapping interactive moves
+ *
+ * Every workspace keeps the vertical and the horizontal edges of its
+ * frames in two arrays sorted by position, and the screen bounds are kept
+ * the same way for all workspaces. A snap check binary-searches each array
+ * for the edges within SNAP_DISTANCE of the moving frame's edges, so it
+ * costs O(log n) per motion rather than a pass over every window.
+ *
+ * The distance works both ways: a frame is pulled onto a nearby edge, and
+ * a frame pushed across one is held there until it is dragged more than
+ * SNAP_DISTANCE past it.
+ */
+class EdgeIndex {
+public:
+    static const int SNAP_DISTANCE = 16;
+
+    struct Stats {
+        unsigned long checks = 0;       // Snap checks, one per applied motion
+        unsigned long probes = 0;       // Edges examined within the distance
+        unsigned long snapped = 0;      // Checks that moved the frame
+        unsigned long updates = 0;
+    };
+
+    void insert(const Window& window, int workspace, const Layout::Rect& frame);
+    void update(const Window& window, const Layout::Rect& frame);
+    void set_workspace(const Window& window, int workspace);
+    void remove(const Window& window);
+
+    /**
+     * @brief Replace the edges frames snap to on every workspace, such as
+     *        the screen or work area
+     */
+    void set_bounds(const std::vector<Layout::Rect>& areas);
+
+    /**
+     * @brief Snap a frame position for @p window to the closest edges
+     *
+     * Edges of the window itself and of minimized windows are ignored.
+     */
+    void snap(WindowStore& store, const Window& window, int& x, int& y);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct Edge {
+        int position;           // x of a vertical edge, y of a horizontal one
+        int start, end;         // Extent along the edge, end exclusive
+        WindowHandle owner;     // Invalid for bounds
+    };
+
+    struct Edges {
+        std::vector<Edge> vertical;
+        std::vector<Edge> horizontal;
+    };
+
+    struct Entry {
+        WindowHandle handle;    // Invalid if the slot is unused
+        int workspace = -1;
+        Layout::Rect rect;
+    };
+
+    static void add_edge(std::vector<Edge>& edges, const Edge& edge);
+    static void remove_edge(std::vector<Edge>& edges, int position, WindowHandle owner);
+
+    Entry* find(const Window& window);
+    Edges& edges_for(int workspace);
+    void link(const Entry& entry);
+    void unlink(const Entry& entry);
+
+    /**
+     * @brief Closest edge to @p position within the snap distance
+     * @param distance In: best distance so far; out: updated if closer
+     * @return true if an edge closer than @p distance was found
+     */
+    bool closest(WindowStore& store, const std::vector<Edge>& edges, WindowHandle self,
+                 int position, int start, int end, int& distance, int& found);
+
+    std::vector<Entry> entries_;    // By WindowStore slot index
+    std::vector<Edges> workspaces_;
+    Edges bounds_;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_EDGE_INDEX_H
@@ -0,0 +1,129 @@
+#include "FramePool.h"
+#include <algorithm>
+
+namespace MalgoroDE {
+
+FramePool::FramePool(Display* display, int screen)
+    : display_(display)
+    , screen_(screen)
+{
+}
+
+FramePool::~FramePool() {
+    for (::Window frame : free_) {
+        XDestroyWindow(display_, frame);
+    }
+}
+
+::Window FramePool::create(int x, int y, int width, int height) {
+    // No background: the decorator paints every exposed pixel, so the
+    // server must not clear the frame first
+    XSetWindowAttributes attrs;
+    attrs.background_pixmap = None;
+    attrs.border_pixel = BlackPixel(display_, screen_);
+    attrs.event_mask = SubstructureRedirectMask | SubstructureNotifyMask |
+                      ButtonPressMask | ButtonReleaseMask |
+                      PointerMotionMask | LeaveWindowMask | ExposureMask;
+
+    return XCreateWindow(display_,
+        RootWindow(display_, screen_),
+        x, y, width, height,
+        0,
+        CopyFromParent,
+        InputOutput,
+        CopyFromParent,
+        CWBackPixmap | CWBorderPixel | CWEventMask,
+        &attrs);
+}
+
+::Window FramePool::acquire(int x, int y, int width, int height) {
+    ::Window frame;
+    bool pooled = !free_.empty();
+    if (pooled) {
+        frame = free_.back();
+        free_.pop_back();
+        XMoveResizeWindow(display_, frame, x, y, width, height);
+        stats_.hits++;
+    } else {
+        frame = create(x, y, width, height);
+        stats_.misses++;
+    }
+
+    pending_.push_back(PendingMap{ frame, pooled, false, false, std::chrono::steady_clock::now() });
+    return frame;
+}
+
+void FramePool::release(::Window frame) {
+    forget_pending(frame);
+
+    if (free_.size() >= CAPACITY) {
+        XDestroyWindow(display_, frame);
+        stats_.destroyed++;
+        return;
+    }
+    XUnmapWindow(display_, frame);
+    free_.push_back(frame);
+    stats_.recycled++;
+}
+
+std::vector<FramePool::PendingMap>::iterator FramePool::find_pending(::Window frame) {
+    return std::find_if(pending_.begin(), pending_.end(),
+        [&](const PendingMap& pending) { return pending.frame == frame; });
+}
+
+void FramePool::note_mapped(::Window frame) {
+    auto it = find_pending(frame);
+    if (it != pending_.end()) {
+        it->mapped = true;
+    }
+}
+
+void FramePool::note_painted(::Window frame) {
+    // Exposes only follow the map, but one may precede its MapNotify
+    auto it = find_pending(frame);
+    if (it == pending_.end()) {
+        return;
+    }
+    it->painted = true;
+    if (!composited_ && it->mapped) {
+        record_visible(*it);
+        pending_.erase(it);
+    }
+}
+
+void FramePool::note_presented() {
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (it->mapped && it->painted) {
+            record_visible(*it);
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FramePool::record_visible(const PendingMap& pending) {
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - pending.start);
+    stats_.shown[pending.pooled]++;
+    stats_.total_visible_latency[pending.pooled] += latency;
+    stats_.max_visible_latency[pending.pooled] =
+        std::max(stats_.max_visible_latency[pending.pooled], latency);
+}
+
+void FramePool::forget_pending(::Window frame) {
+    // Frames of windows that were never shown (e.g. started minimized)
+    auto it = find_pending(frame);
+    if (it != pending_.end()) {
+        pending_.erase(it);
+    }
+}
+
+void FramePool::refill() {
+    while (free_.size() < TARGET) {
+        free_.push_back(create(0, 0, 1, 1));
+        stats_.refilled++;
+    }
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,104 @@
+#ifndef MALGORO_FRAME_POOL_H
+#define MALGORO_FRAME_POOL_H
+
+#include <chrono>
+#include <vector>
+#include <X11/Xlib.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Pre-created frame windows
+ *
+ * Tooltips, dialogs and popups are managed and unmanaged constantly; each
+ * one used to cost a frame XCreateWindow and XDestroyWindow. Frames are
+ * instead taken from a pool of unmapped ones with the frame attributes and
+ * event mask already set, returned to it on unmanage, and the pool is
+ * topped up to TARGET while the event queue is empty. At most CAPACITY
+ * frames are kept; beyond that they are destroyed as before.
+ *
+ * Map-to-visible latency runs from taking a frame until it is on screen:
+ * mapped and its decoration painted, and with a compositor also the first
+ * composited frame presented after that. It is recorded separately for
+ * pooled and newly created frames so the two can be compared.
+ */
+class FramePool {
+public:
+    static const size_t TARGET = 4;
+    static const size_t CAPACITY = 16;
+
+    struct Stats {
+        unsigned long hits = 0;
+        unsigned long misses = 0;       // Pool empty; frame created on demand
+        unsigned long recycled = 0;
+        unsigned long destroyed = 0;    // Released with the pool full
+        unsigned long refilled = 0;     // Created while idle
+
+        // Indexed by whether the frame came from the pool
+        unsigned long shown[2] = { 0, 0 };
+        std::chrono::microseconds total_visible_latency[2] = {};
+        std::chrono::microseconds max_visible_latency[2] = {};
+    };
+
+    FramePool(Display* display, int screen);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief Take an unmapped frame and move it to the given geometry
+     */
+    ::Window acquire(int x, int y, int width, int height);
+
+    /**
+     * @brief Unmap a frame for reuse, or destroy it if the pool is full
+     *
+     * Its child must already have been reparented out.
+     */
+    void release(::Window frame);
+
+    /**
+     * @brief Whether frames only become visible with a composited frame
+     */
+    void set_composited(bool composited) { composited_ = composited; }
+
+    // Progress of frames taken with acquire() towards being visible
+    void note_mapped(::Window frame);
+    void note_painted(::Window frame);  // Decoration drawn after an Expose
+    void note_presented();              // Composited frame presented
+
+    bool needs_refill() const { return free_.size() < TARGET; }
+
+    /**
+     * @brief Create frames until the pool holds TARGET
+     */
+    void refill();
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct PendingMap {
+        ::Window frame;
+        bool pooled;
+        bool mapped;
+        bool painted;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    ::Window create(int x, int y, int width, int height);
+    std::vector<PendingMap>::iterator find_pending(::Window frame);
+    void forget_pending(::Window frame);
+    void record_visible(const PendingMap& pending);
+
+    Display* display_;
+    int screen_;
+    std::vector<::Window> free_;
+    std::vector<PendingMap> pending_;   // Acquired, not yet visible
+    bool composited_ = false;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_FRAME_POOL_H
@@ -0,0 +1,101 @@
+#ifndef MALGORO_HANDLE_LIST_H
+#define MALGORO_HANDLE_LIST_H
+
+#include <cstddef>
+#include "Window.h"
+#include "WindowStore.h"
+
+namespace MalgoroDE {
+
+/**
+ * @brief Intrusive list of windows threaded through a WindowLink member
+ *
+ * Nodes are the Window records themselves, so insert, remove and
+ * move-to-front are O(1) and never allocate. Each link member can belong
+ * to at most one list at a time.
+ */
+template <WindowLink Window::*Link>
+class HandleList {
+public:
+    WindowHandle front() const { return head_; }
+    WindowHandle back() const { return tail_; }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    static bool contains(const Window& window) { return (window.*Link).linked; }
+
+    static WindowHandle next(const Window& window) { return (window.*Link).next; }
+    static WindowHandle prev(const Window& window) { return (window.*Link).prev; }
+
+    void push_front(WindowStore& store, Window& window) {
+        WindowLink& link = window.*Link;
+        link.prev = WindowHandle();
+        link.next = head_;
+        link.linked = true;
+        if (Window* old_head = store.get(head_)) {
+            (old_head->*Link).prev = window.get_handle();
+        } else {
+            tail_ = window.get_handle();
+        }
+        head_ = window.get_handle();
+        count_++;
+    }
+
+    void push_back(WindowStore& store, Window& window) {
+        WindowLink& link = window.*Link;
+        link.prev = tail_;
+        link.next = WindowHandle();
+        link.linked = true;
+        if (Window* old_tail = store.get(tail_)) {
+            (old_tail->*Link).next = window.get_handle();
+        } else {
+            head_ = window.get_handle();
+        }
+        tail_ = window.get_handle();
+        count_++;
+    }
+
+    void remove(WindowStore& store, Window& window) {
+        WindowLink& link = window.*Link;
+        if (!link.linked) {
+            return;
+        }
+        if (Window* prev = store.get(link.prev)) {
+            (prev->*Link).next = link.next;
+        } else {
+            head_ = link.next;
+        }
+        if (Window* next = store.get(link.next)) {
+            (next->*Link).prev = link.prev;
+        } else {
+            tail_ = link.prev;
+        }
+        link = WindowLink();
+        count_--;
+    }
+
+    void move_to_front(WindowStore& store, Window& window) {
+        if (head_ == window.get_handle()) {
+            return;
+        }
+        remove(store, window);
+        push_front(store, window);
+    }
+
+    void move_to_back(WindowStore& store, Window& window) {
+        if (tail_ == window.get_handle()) {
+            return;
+        }
+        remove(store, window);
+        push_back(store, window);
+    }
+
+private:
+    WindowHandle head_;
+    WindowHandle tail_;
+    size_t count_ = 0;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_HANDLE_LIST_H
@@ -0,0 +1,151 @@
+#include "Layout.h"
+#include <algorithm>
+#include <cmath>
+
+namespace MalgoroDE {
+
+namespace {
+
+// Split @p length into @p count parts; the remainder goes to the first parts
+void split(int start, int length, int count, int index, int& offset, int& size) {
+    int base = length / count;
+    int extra = length % count;
+    offset = start + index * base + std::min(index, extra);
+    size = base + (index < extra ? 1 : 0);
+}
+
+class TileLayout : public Layout {
+public:
+    Kind get_kind() const override { return Kind::TILE; }
+
+    void arrange(const Rect& area, int count, int first, Rect* out) const override {
+        for (int i = first; i < count; ++i) {
+            out[i].x = area.x;
+            out[i].width = area.width;
+            split(area.y, area.height, count, i, out[i].y, out[i].height);
+        }
+    }
+};
+
+class ColumnsLayout : public Layout {
+public:
+    Kind get_kind() const override { return Kind::COLUMNS; }
+
+    void arrange(const Rect& area, int count, int first, Rect* out) const override {
+        for (int i = first; i < count; ++i) {
+            out[i].y = area.y;
+            out[i].height = area.height;
+            split(area.x, area.width, count, i, out[i].x, out[i].width);
+        }
+    }
+};
+
+class MasterStackLayout : public Layout {
+public:
+    static constexpr double MASTER_RATIO = 0.55;
+
+    Kind get_kind() const override { return Kind::MASTER_STACK; }
+
+    void arrange(const Rect& area, int count, int first, Rect* out) const override {
+        if (count == 1) {
+            if (first == 0) {
+                out[0] = area;
+            }
+            return;
+        }
+
+        int master_width = static_cast<int>(area.width * MASTER_RATIO);
+        if (first == 0) {
+            out[0] = Rect{ area.x, area.y, master_width, area.height };
+        }
+
+        int stack = count - 1;
+        for (int i = std::max(first, 1); i < count; ++i) {
+            out[i].x = area.x + master_width;
+            out[i].width = area.width - master_width;
+            split(area.y, area.height, stack, i - 1, out[i].y, out[i].height);
+        }
+    }
+
+    int stable_slots(int before, int after) const override {
+        // The master keeps its place while there is a stack beside it
+        return before > 1 && after > 1 ? 1 : 0;
+    }
+};
+
+class GridLayout : public Layout {
+public:
+    Kind get_kind() const override { return Kind::GRID; }
+
+    void arrange(const Rect& area, int count, int first, Rect* out) const override {
+        int columns, rows;
+        dimensions(count, columns, rows);
+        for (int i = first; i < count; ++i) {
+            split(area.x, area.width, columns, i % columns, out[i].x, out[i].width);
+            split(area.y, area.height, rows, i / columns, out[i].y, out[i].height);
+        }
+    }
+
+    int stable_slots(int before, int after) const override {
+        // Cells only move when the grid changes shape
+        int before_columns, before_rows, after_columns, after_rows;
+        dimensions(before, before_columns, before_rows);
+        dimensions(after, after_columns, after_rows);
+        if (before_columns != after_columns || before_rows != after_rows) {
+            return 0;
+        }
+        return std::min(before, after);
+    }
+
+private:
+    static void dimensions(int count, int& columns, int& rows) {
+        columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count)))));
+        rows = std::max(1, (count + columns - 1) / columns);
+    }
+};
+
+class CascadeLayout : public Layout {
+public:
+    static const int STEP = 32;
+
+    Kind get_kind() const override { return Kind::CASCADE; }
+
+    void arrange(const Rect& area, int count, int first, Rect* out) const override {
+        // Windows take two thirds of the area and restart at the top-left
+        // once a step would push them out of it
+        int width = area.width * 2 / 3;
+        int height = area.height * 2 / 3;
+        int steps = std::max(1, std::min(area.width - width, area.height - height) / STEP + 1);
+        for (int i = first; i < count; ++i) {
+            int step = i % steps;
+            out[i] = Rect{ area.x + step * STEP, area.y + step * STEP, width, height };
+        }
+    }
+
+    int stable_slots(int before, int after) const override {
+        // Each slot's position only depends on its index
+        return std::min(before, after);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Layout> Layout::create(Kind kind) {
+    switch (kind) {
+        case Kind::TILE:
+            return std::make_unique<TileLayout>();
+        case Kind::COLUMNS:
+            return std::make_unique<ColumnsLayout>();
+        case Kind::MASTER_STACK:
+            return std::make_unique<MasterStackLayout>();
+        case Kind::GRID:
+            return std::make_unique<GridLayout>();
+        case Kind::CASCADE:
+            return std::make_unique<CascadeLayout>();
+        case Kind::NONE:
+            break;
+    }
+    return nullptr;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,62 @@
+#ifndef MALGORO_LAYOUT_H
+#define MALGORO_LAYOUT_H
+
+#include <memory>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Placement algorithm for the windows of a workspace
+ *
+ * A layout maps slot indices (0 = first window in layout order) to frame
+ * rectangles inside a work area. It is stateless: the same area and count
+ * always give the same rectangles, which lets LayoutEngine recompute only
+ * the slots a change actually affects.
+ */
+class Layout {
+public:
+    enum class Kind {
+        NONE,           // Windows are placed freely
+        TILE,           // Full-width rows, top to bottom
+        COLUMNS,        // Full-height columns, left to right
+        MASTER_STACK,   // First window on the left, the rest stacked on the right
+        GRID,           // Near-square grid of equal cells
+        CASCADE         // Overlapping, stepped down and right
+    };
+
+    struct Rect {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+
+        bool operator==(const Rect& other) const = default;
+    };
+
+    /**
+     * @brief Create a built-in layout
+     * @return nullptr for Kind::NONE
+     */
+    static std::unique_ptr<Layout> create(Kind kind);
+
+    virtual ~Layout() = default;
+
+    virtual Kind get_kind() const = 0;
+
+    /**
+     * @brief Compute the frame rectangles of slots [first, count)
+     * @param out Array of at least @p count rectangles; slots before
+     *            @p first are left untouched
+     */
+    virtual void arrange(const Rect& area, int count, int first, Rect* out) const = 0;
+
+    /**
+     * @brief Number of leading slots whose rectangles stay the same when the
+     *        window count changes from @p before to @p after
+     */
+    virtual int stable_slots(int /*before*/, int /*after*/) const { return 0; }
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_LAYOUT_H
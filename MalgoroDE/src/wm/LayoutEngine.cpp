@@ -0,0 +1,144 @@
+#include "LayoutEngine.h"
+#include "Window.h"
+#include "WindowStore.h"
+#include "Workspace.h"
+#include <algorithm>
+
+namespace MalgoroDE {
+
+bool LayoutEngine::is_tileable(const Window& window) {
+    return window.get_type() == Window::Type::NORMAL && !window.is_minimized() &&
+           !window.is_maximized() && !window.is_fullscreen() && !window.is_sticky();
+}
+
+LayoutEngine::Arrangement* LayoutEngine::find(int workspace) {
+    if (workspace < 0 || workspace >= static_cast<int>(arrangements_.size()) ||
+        !arrangements_[workspace].layout) {
+        return nullptr;
+    }
+    return &arrangements_[workspace];
+}
+
+Layout::Kind LayoutEngine::get_layout(int workspace) const {
+    if (workspace < 0 || workspace >= static_cast<int>(arrangements_.size()) ||
+        !arrangements_[workspace].layout) {
+        return Layout::Kind::NONE;
+    }
+    return arrangements_[workspace].layout->get_kind();
+}
+
+void LayoutEngine::set_layout(WindowStore& store, const Workspace& workspace, Layout::Kind kind,
+                              const Layout::Rect& area) {
+    int index = workspace.get_index();
+    if (index < 0) {
+        return;
+    }
+    if (index >= static_cast<int>(arrangements_.size())) {
+        arrangements_.resize(index + 1);
+    }
+
+    Arrangement& arrangement = arrangements_[index];
+    arrangement.layout = Layout::create(kind);
+    arrangement.area = area;
+    arrangement.slots.clear();
+    arrangement.rects.clear();
+    if (!arrangement.layout) {
+        return;
+    }
+
+    for (Window* window = store.get(workspace.get_most_recent()); window;
+         window = store.get(Workspace::next_recent(*window))) {
+        if (is_tileable(*window)) {
+            arrangement.slots.push_back(window->get_handle());
+        }
+    }
+    update(store, arrangement, 0);
+}
+
+void LayoutEngine::set_area(WindowStore& store, int workspace, const Layout::Rect& area) {
+    Arrangement* arrangement = find(workspace);
+    if (!arrangement || arrangement->area == area) {
+        return;
+    }
+    arrangement->area = area;
+    update(store, *arrangement, 0);
+}
+
+void LayoutEngine::window_added(WindowStore& store, int workspace, Window& window) {
+    Arrangement* arrangement = find(workspace);
+    if (!arrangement || !is_tileable(window) ||
+        std::find(arrangement->slots.begin(), arrangement->slots.end(),
+            window.get_handle()) != arrangement->slots.end()) {
+        return;
+    }
+
+    int before = arrangement->slots.size();
+    arrangement->slots.push_back(window.get_handle());
+    update(store, *arrangement, arrangement->layout->stable_slots(before, before + 1));
+}
+
+void LayoutEngine::window_removed(WindowStore& store, int workspace, Window& window) {
+    Arrangement* arrangement = find(workspace);
+    if (!arrangement) {
+        return;
+    }
+
+    auto slot = std::find(arrangement->slots.begin(), arrangement->slots.end(), window.get_handle());
+    if (slot == arrangement->slots.end()) {
+        return;
+    }
+
+    // Slots after the removed one shift down and must be recomputed
+    int before = arrangement->slots.size();
+    int removed = slot - arrangement->slots.begin();
+    arrangement->slots.erase(slot);
+    if (removed < static_cast<int>(arrangement->rects.size())) {
+        arrangement->rects.erase(arrangement->rects.begin() + removed);
+    }
+    int first = std::min(removed, arrangement->layout->stable_slots(before, before - 1));
+    update(store, *arrangement, first);
+}
+
+void LayoutEngine::update(WindowStore& store, Arrangement& arrangement, int first) {
+    int count = arrangement.slots.size();
+    if (count == 0) {
+        arrangement.rects.clear();
+        return;
+    }
+
+    first = std::min(first, static_cast<int>(arrangement.rects.size()));
+    arrangement.rects.resize(count);
+    arrangement.layout->arrange(arrangement.area, count, first, arrangement.rects.data());
+
+    stats_.arranges++;
+    stats_.slots_reused += first;
+    stats_.slots_computed += count - first;
+
+    for (int i = first; i < count; ++i) {
+        if (Window* window = store.get(arrangement.slots[i])) {
+            apply(*window, arrangement.rects[i]);
+        }
+    }
+}
+
+void LayoutEngine::apply(Window& window, const Layout::Rect& rect) {
+    // Frame rectangle to client size, then the client's own size hints
+    int border = window.get_border_width();
+    int titlebar = window.get_titlebar_height();
+    int width = std::max(1, rect.width - 2 * border);
+    int height = std::max(1, rect.height - titlebar - border);
+    window.constrain_size(width, height);
+
+    int x, y, frame_width, frame_height;
+    window.get_frame_geometry(x, y, frame_width, frame_height);
+    if (x == rect.x && y == rect.y &&
+        frame_width == width + 2 * border && frame_height == height + titlebar + border) {
+        stats_.unchanged++;
+        return;
+    }
+
+    window.set_geometry(rect.x, rect.y, width, height);
+    stats_.configures++;
+}
+
+} // namespace MalgoroDE
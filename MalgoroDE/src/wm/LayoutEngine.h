@@ -0,0 +1,81 @@
+#ifndef MALGORO_LAYOUT_ENGINE_H
+#define MALGORO_LAYOUT_ENGINE_H
+
+#include <memory>
+#include <vector>
+#include "Layout.h"
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+class Window;
+class WindowStore;
+class Workspace;
+
+/**
+ * @brief Per-workspace layouts and their current arrangement
+ *
+ * Every workspace with a layout keeps its windows in slot order together
+ * with the rectangles last computed for them. Adding or removing a window
+ * only recomputes the slots the layout reports as affected, and a window
+ * is only reconfigured if its frame is not already where it should be, so
+ * the whole change goes out as one batch of the configures that matter.
+ */
+class LayoutEngine {
+public:
+    struct Stats {
+        unsigned long arranges = 0;
+        unsigned long slots_computed = 0;
+        unsigned long slots_reused = 0;     // Kept from the previous arrangement
+        unsigned long configures = 0;
+        unsigned long unchanged = 0;        // Computed, but already in place
+    };
+
+    /**
+     * @brief Whether a window takes part in layouts
+     *
+     * Only normal windows that are neither minimized, maximized,
+     * fullscreen nor sticky are arranged.
+     */
+    static bool is_tileable(const Window& window);
+
+    /**
+     * @brief Lay out a workspace, or release it with Kind::NONE
+     *
+     * Windows are slotted most recently used first, so the window in use
+     * becomes the master of a master-stack layout.
+     */
+    void set_layout(WindowStore& store, const Workspace& workspace, Layout::Kind kind,
+                    const Layout::Rect& area);
+    Layout::Kind get_layout(int workspace) const;
+
+    /**
+     * @brief Re-arrange a workspace for a new work area
+     */
+    void set_area(WindowStore& store, int workspace, const Layout::Rect& area);
+
+    // Incremental updates; no-ops on workspaces without a layout
+    void window_added(WindowStore& store, int workspace, Window& window);
+    void window_removed(WindowStore& store, int workspace, Window& window);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct Arrangement {
+        std::unique_ptr<Layout> layout;
+        Layout::Rect area;
+        std::vector<WindowHandle> slots;
+        std::vector<Layout::Rect> rects;
+    };
+
+    Arrangement* find(int workspace);
+    void update(WindowStore& store, Arrangement& arrangement, int first);
+    void apply(Window& window, const Layout::Rect& rect);
+
+    std::vector<Arrangement> arrangements_;     // By workspace index
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_LAYOUT_ENGINE_H
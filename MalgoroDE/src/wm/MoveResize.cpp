@@ -0,0 +1,365 @@
+#include "MoveResize.h"
+#include "Atoms.h"
+#include "EdgeIndex.h"
+#include "Window.h"
+#include "WindowStore.h"
+#include <X11/cursorfont.h>
+#include <cstring>
+
+namespace MalgoroDE {
+
+namespace {
+
+// _NET_WM_MOVERESIZE directions, in protocol order
+const int moveresize_edges[] = {
+    MoveResize::EDGE_TOP | MoveResize::EDGE_LEFT,       // _NET_WM_MOVERESIZE_SIZE_TOPLEFT
+    MoveResize::EDGE_TOP,                               // _NET_WM_MOVERESIZE_SIZE_TOP
+    MoveResize::EDGE_TOP | MoveResize::EDGE_RIGHT,      // _NET_WM_MOVERESIZE_SIZE_TOPRIGHT
+    MoveResize::EDGE_RIGHT,                             // _NET_WM_MOVERESIZE_SIZE_RIGHT
+    MoveResize::EDGE_BOTTOM | MoveResize::EDGE_RIGHT,   // _NET_WM_MOVERESIZE_SIZE_BOTTOMRIGHT
+    MoveResize::EDGE_BOTTOM,                            // _NET_WM_MOVERESIZE_SIZE_BOTTOM
+    MoveResize::EDGE_BOTTOM | MoveResize::EDGE_LEFT,    // _NET_WM_MOVERESIZE_SIZE_BOTTOMLEFT
+    MoveResize::EDGE_LEFT,                              // _NET_WM_MOVERESIZE_SIZE_LEFT
+};
+
+const long MOVERESIZE_MOVE = 8;
+const long MOVERESIZE_SIZE_KEYBOARD = 9;
+const long MOVERESIZE_MOVE_KEYBOARD = 10;
+
+// Cursor font glyph per edge mask (0 = move)
+unsigned int cursor_shape(int edges) {
+    switch (edges) {
+        case MoveResize::EDGE_TOP: return XC_top_side;
+        case MoveResize::EDGE_BOTTOM: return XC_bottom_side;
+        case MoveResize::EDGE_LEFT: return XC_left_side;
+        case MoveResize::EDGE_RIGHT: return XC_right_side;
+        case MoveResize::EDGE_TOP | MoveResize::EDGE_LEFT: return XC_top_left_corner;
+        case MoveResize::EDGE_TOP | MoveResize::EDGE_RIGHT: return XC_top_right_corner;
+        case MoveResize::EDGE_BOTTOM | MoveResize::EDGE_LEFT: return XC_bottom_left_corner;
+        case MoveResize::EDGE_BOTTOM | MoveResize::EDGE_RIGHT: return XC_bottom_right_corner;
+        default: return XC_fleur;
+    }
+}
+
+void int64_to_value(int64_t value, XSyncValue& out) {
+    XSyncIntsToValue(&out, static_cast<unsigned int>(value & 0xffffffff),
+        static_cast<int>(value >> 32));
+}
+
+int64_t value_to_int64(const XSyncValue& value) {
+    return (static_cast<int64_t>(XSyncValueHigh32(value)) << 32) |
+        static_cast<int64_t>(XSyncValueLow32(value));
+}
+
+} // namespace
+
+MoveResize::MoveResize(Display* display, ::Window root)
+    : display_(display)
+    , root_(root)
+    , mode_(Mode::NONE)
+    , edges_(0)
+    , time_(CurrentTime)
+    , start_pointer_x_(0), start_pointer_y_(0)
+    , start_x_(0), start_y_(0)
+    , start_width_(0), start_height_(0)
+    , pointer_x_(0), pointer_y_(0)
+    , pending_(false)
+    , sync_available_(false)
+    , sync_event_base_(0)
+    , alarm_(None)
+    , counter_(None)
+    , sync_value_(0)
+    , waiting_for_sync_(false)
+    , snap_edges_(nullptr)
+{
+    for (Cursor& cursor : cursors_) {
+        cursor = None;
+    }
+}
+
+MoveResize::~MoveResize() {
+    if (mode_ != Mode::NONE) {
+        release();
+    }
+    for (Cursor cursor : cursors_) {
+        if (cursor != None) {
+            XFreeCursor(display_, cursor);
+        }
+    }
+}
+
+bool MoveResize::init_sync() {
+    int error_base;
+    int major, minor;
+    sync_available_ = XSyncQueryExtension(display_, &sync_event_base_, &error_base) &&
+        XSyncInitialize(display_, &major, &minor);
+    return sync_available_;
+}
+
+bool MoveResize::direction_to_edges(long direction, Mode& mode, int& edges) {
+    if (direction >= 0 && direction < (long)(sizeof(moveresize_edges) / sizeof(moveresize_edges[0]))) {
+        mode = Mode::RESIZE;
+        edges = moveresize_edges[direction];
+        return true;
+    }
+
+    // Keyboard variants are driven by the pointer as well
+    if (direction == MOVERESIZE_SIZE_KEYBOARD) {
+        mode = Mode::RESIZE;
+        edges = EDGE_BOTTOM | EDGE_RIGHT;
+        return true;
+    }
+    if (direction == MOVERESIZE_MOVE || direction == MOVERESIZE_MOVE_KEYBOARD) {
+        mode = Mode::MOVE;
+        edges = 0;
+        return true;
+    }
+    return false;
+}
+
+bool MoveResize::begin(Window& window, Mode mode, int edges, int root_x, int root_y, Time time) {
+    if (mode_ != Mode::NONE || mode == Mode::NONE) {
+        return false;
+    }
+    if (mode == Mode::RESIZE && !edges) {
+        return false;
+    }
+
+    // Re-grabbing converts an implicit or passive button grab into ours
+    int result = XGrabPointer(display_, root_, False,
+        ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
+        GrabModeAsync, GrabModeAsync, None, cursor_for(mode, edges), time);
+    if (result != GrabSuccess) {
+        return false;
+    }
+
+    mode_ = mode;
+    handle_ = window.get_handle();
+    edges_ = mode == Mode::RESIZE ? edges : 0;
+    time_ = time;
+
+    start_pointer_x_ = pointer_x_ = root_x;
+    start_pointer_y_ = pointer_y_ = root_y;
+    start_x_ = window.get_x();
+    start_y_ = window.get_y();
+    start_width_ = window.get_width();
+    start_height_ = window.get_height();
+    pending_ = false;
+
+    // The counter's current value is read once per grab; requests then
+    // count upwards from it
+    if (mode_ == Mode::RESIZE && sync_available_ && window.supports_sync_request()) {
+        XSyncValue value;
+        if (XSyncQueryCounter(display_, window.get_sync_counter(), &value)) {
+            counter_ = window.get_sync_counter();
+            sync_value_ = value_to_int64(value);
+            waiting_for_sync_ = false;
+
+            XSyncAlarmAttributes attrs;
+            attrs.trigger.counter = counter_;
+            attrs.trigger.value_type = XSyncAbsolute;
+            int64_to_value(sync_value_, attrs.trigger.wait_value);
+            attrs.trigger.test_type = XSyncPositiveComparison;
+            attrs.events = True;
+            alarm_ = XSyncCreateAlarm(display_,
+                XSyncCACounter | XSyncCAValueType | XSyncCAValue |
+                XSyncCATestType | XSyncCAEvents, &attrs);
+        }
+    }
+
+    stats_.grabs++;
+    return true;
+}
+
+void MoveResize::motion(int root_x, int root_y, Time time) {
+    if (mode_ == Mode::NONE) {
+        return;
+    }
+
+    pointer_x_ = root_x;
+    pointer_y_ = root_y;
+    time_ = time;
+    pending_ = true;
+    stats_.motions++;
+}
+
+void MoveResize::flush(WindowStore& store) {
+    if (mode_ == Mode::NONE || !pending_) {
+        return;
+    }
+
+    Window* window = store.get(handle_);
+    if (!window) {
+        release();
+        return;
+    }
+
+    if (waiting_for_sync_) {
+        if (std::chrono::steady_clock::now() - sync_sent_ < SYNC_TIMEOUT) {
+            // Keep the position; it is applied when the client catches up
+            stats_.sync_deferred++;
+            return;
+        }
+        waiting_for_sync_ = false;
+        stats_.sync_timeouts++;
+    }
+
+    apply(store, *window, true);
+}
+
+int MoveResize::get_flush_delay() const {
+    if (mode_ == Mode::NONE || !pending_ || !waiting_for_sync_) {
+        return -1;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - sync_sent_;
+    if (elapsed >= SYNC_TIMEOUT) {
+        return 0;
+    }
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(SYNC_TIMEOUT - elapsed);
+    return static_cast<int>(remaining.count());
+}
+
+void MoveResize::end(WindowStore& store, bool cancel) {
+    if (mode_ == Mode::NONE) {
+        return;
+    }
+
+    if (Window* window = store.get(handle_)) {
+        if (cancel) {
+            pointer_x_ = start_pointer_x_;
+            pointer_y_ = start_pointer_y_;
+            pending_ = true;
+        }
+
+        // The final geometry is sent regardless of any outstanding sync
+        if (pending_) {
+            apply(store, *window, false);
+        }
+    }
+
+    release();
+}
+
+bool MoveResize::handle_sync_event(const XEvent& event) {
+    if (!sync_available_ || event.type != sync_event_base_ + XSyncAlarmNotify) {
+        return false;
+    }
+
+    const XSyncAlarmNotifyEvent& alarm_event =
+        reinterpret_cast<const XSyncAlarmNotifyEvent&>(event);
+    if (alarm_ != None && alarm_event.alarm == alarm_ &&
+        value_to_int64(alarm_event.counter_value) >= sync_value_) {
+        // Any position recorded meanwhile goes out at the end of this batch
+        waiting_for_sync_ = false;
+    }
+    return true;
+}
+
+void MoveResize::apply(WindowStore& store, Window& window, bool paced) {
+    pending_ = false;
+
+    int dx = pointer_x_ - start_pointer_x_;
+    int dy = pointer_y_ - start_pointer_y_;
+
+    if (mode_ == Mode::MOVE) {
+        // Without a delta (a click, or a cancel) the window stays exactly
+        // where it started
+        int x = start_x_ + dx;
+        int y = start_y_ + dy;
+        if (snap_edges_ && (dx || dy)) {
+            snap_edges_->snap(store, window, x, y);
+        }
+        window.move(x, y);
+        stats_.applied++;
+        return;
+    }
+
+    int width = start_width_;
+    int height = start_height_;
+    if (edges_ & EDGE_LEFT) {
+        width -= dx;
+    } else if (edges_ & EDGE_RIGHT) {
+        width += dx;
+    }
+    if (edges_ & EDGE_TOP) {
+        height -= dy;
+    } else if (edges_ & EDGE_BOTTOM) {
+        height += dy;
+    }
+    window.constrain_size(width, height);
+
+    // Keep the edges opposite the dragged ones where they started
+    int x = start_x_;
+    int y = start_y_;
+    if (edges_ & EDGE_LEFT) {
+        x = start_x_ + start_width_ - width;
+    }
+    if (edges_ & EDGE_TOP) {
+        y = start_y_ + start_height_ - height;
+    }
+
+    if (x == window.get_x() && y == window.get_y() &&
+        width == window.get_width() && height == window.get_height()) {
+        return;
+    }
+
+    if (alarm_ != None && window.get_xwindow() != None) {
+        send_sync_request(window);
+        if (paced) {
+            waiting_for_sync_ = true;
+            sync_sent_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    window.set_geometry(x, y, width, height);
+    stats_.applied++;
+}
+
+void MoveResize::send_sync_request(Window& window) {
+    sync_value_++;
+
+    XEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = ClientMessage;
+    event.xclient.window = window.get_xwindow();
+    event.xclient.message_type = atoms().wm_protocols;
+    event.xclient.format = 32;
+    event.xclient.data.l[0] = atoms().net_wm_sync_request;
+    event.xclient.data.l[1] = time_;
+    event.xclient.data.l[2] = static_cast<long>(sync_value_ & 0xffffffff);
+    event.xclient.data.l[3] = static_cast<long>(sync_value_ >> 32);
+    XSendEvent(display_, window.get_xwindow(), False, NoEventMask, &event);
+
+    // Fire once the client has set the counter to the new value
+    XSyncAlarmAttributes attrs;
+    int64_to_value(sync_value_, attrs.trigger.wait_value);
+    XSyncChangeAlarm(display_, alarm_, XSyncCAValue, &attrs);
+
+    stats_.sync_requests++;
+}
+
+void MoveResize::release() {
+    XUngrabPointer(display_, CurrentTime);
+
+    if (alarm_ != None) {
+        XSyncDestroyAlarm(display_, alarm_);
+        alarm_ = None;
+    }
+    counter_ = None;
+    waiting_for_sync_ = false;
+
+    mode_ = Mode::NONE;
+    handle_ = WindowHandle();
+    pending_ = false;
+}
+
+Cursor MoveResize::cursor_for(Mode mode, int edges) {
+    int index = mode == Mode::RESIZE ? (edges & 15) : 0;
+    if (cursors_[index] == None) {
+        cursors_[index] = XCreateFontCursor(display_, cursor_shape(index));
+    }
+    return cursors_[index];
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,163 @@
+#ifndef MALGORO_MOVE_RESIZE_H
+#define MALGORO_MOVE_RESIZE_H
+
+#include <chrono>
+#include <cstdint>
+#include <X11/Xlib.h>
+#include <X11/extensions/sync.h>
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+class EdgeIndex;
+class Window;
+class WindowStore;
+
+/**
+ * @brief Interactive (opaque) move and resize of a single window
+ *
+ * Pointer motion only records the latest position; the geometry is applied
+ * once per event batch by flush(), so a burst of motion costs one configure.
+ * Resizes of clients that support _NET_WM_SYNC_REQUEST are paced by the
+ * client's XSync counter: a new size is not sent until the client reports
+ * it has handled the previous one, or SYNC_TIMEOUT has passed.
+ *
+ * Geometry is always computed from the grab-start geometry plus the total
+ * pointer delta, so size-increment rounding never accumulates. Moves are
+ * snapped to nearby edges when an EdgeIndex is set.
+ */
+class MoveResize {
+public:
+    enum class Mode {
+        NONE,
+        MOVE,
+        RESIZE
+    };
+
+    // Edges being dragged; the values match Decorator::BorderMask
+    enum Edge {
+        EDGE_TOP = 1,
+        EDGE_BOTTOM = 2,
+        EDGE_LEFT = 4,
+        EDGE_RIGHT = 8
+    };
+
+    struct Stats {
+        unsigned long grabs = 0;
+        unsigned long motions = 0;          // Pointer positions recorded
+        unsigned long applied = 0;          // Geometry changes sent
+        unsigned long sync_requests = 0;
+        unsigned long sync_deferred = 0;    // Flushes held back by a pending sync
+        unsigned long sync_timeouts = 0;
+    };
+
+    MoveResize(Display* display, ::Window root);
+    ~MoveResize();
+
+    MoveResize(const MoveResize&) = delete;
+    MoveResize& operator=(const MoveResize&) = delete;
+
+    /**
+     * @brief Set up the XSync extension for resize pacing
+     * @return false if XSync is unavailable (resizes are then unpaced)
+     */
+    bool init_sync();
+
+    /**
+     * @brief Snap moves to the edges in @p edges (nullptr disables snapping)
+     */
+    void set_snapping(EdgeIndex* edges) { snap_edges_ = edges; }
+
+    /**
+     * @brief Map a _NET_WM_MOVERESIZE direction to a mode and edge mask
+     * @return false for _NET_WM_MOVERESIZE_CANCEL and unknown directions
+     */
+    static bool direction_to_edges(long direction, Mode& mode, int& edges);
+
+    bool is_active() const { return mode_ != Mode::NONE; }
+    Mode get_mode() const { return mode_; }
+    WindowHandle get_window() const { return handle_; }
+
+    /**
+     * @brief Grab the pointer and start moving or resizing
+     * @param edges Edge mask for RESIZE, ignored for MOVE
+     */
+    bool begin(Window& window, Mode mode, int edges, int root_x, int root_y, Time time);
+
+    /**
+     * @brief Record the latest pointer position
+     */
+    void motion(int root_x, int root_y, Time time);
+
+    /**
+     * @brief Apply the latest pointer position (called once per event batch)
+     */
+    void flush(WindowStore& store);
+
+    /**
+     * @brief Milliseconds until a position held back by a sync request
+     *        goes out regardless
+     * @return -1 if nothing is held back, 0 if SYNC_TIMEOUT has passed
+     */
+    int get_flush_delay() const;
+
+    /**
+     * @brief Finish the operation and release the grab
+     * @param cancel Restore the geometry the window had when the grab began
+     */
+    void end(WindowStore& store, bool cancel = false);
+
+    /**
+     * @brief Consume an XSync alarm event
+     * @return false if the event is not an XSync alarm event
+     */
+    bool handle_sync_event(const XEvent& event);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    // Longest wait for a client to acknowledge a sync request
+    static constexpr std::chrono::milliseconds SYNC_TIMEOUT{100};
+
+    void apply(WindowStore& store, Window& window, bool paced);
+    void send_sync_request(Window& window);
+    void release();
+    Cursor cursor_for(Mode mode, int edges);
+
+    Display* display_;
+    ::Window root_;
+
+    Mode mode_;
+    WindowHandle handle_;
+    int edges_;
+    Time time_;
+
+    // Grab-start state
+    int start_pointer_x_, start_pointer_y_;
+    int start_x_, start_y_;
+    int start_width_, start_height_;
+
+    // Latest pointer position, not yet applied
+    int pointer_x_, pointer_y_;
+    bool pending_;
+
+    // XSync pacing
+    bool sync_available_;
+    int sync_event_base_;
+    XSyncAlarm alarm_;
+    XSyncCounter counter_;
+    int64_t sync_value_;
+    bool waiting_for_sync_;
+    std::chrono::steady_clock::time_point sync_sent_;
+
+    EdgeIndex* snap_edges_;
+
+    // Cursors, indexed by edge mask (0 = move)
+    Cursor cursors_[16];
+
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_MOVE_RESIZE_H
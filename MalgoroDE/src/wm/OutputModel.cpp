@@ -0,0 +1,203 @@
+#include "OutputModel.h"
+#include <X11/extensions/Xrandr.h>
+#include <algorithm>
+#include <climits>
+
+namespace MalgoroDE {
+
+OutputModel::OutputModel(Display* display, ::Window root)
+    : display_(display)
+    , root_(root)
+    , available_(false)
+    , dirty_(true)
+    , event_base_(0)
+    , primary_(0)
+{
+}
+
+bool OutputModel::initialize() {
+    int error_base;
+    int major = 0;
+    int minor = 0;
+    if (!XRRQueryExtension(display_, &event_base_, &error_base) ||
+        !XRRQueryVersion(display_, &major, &minor) ||
+        major < 1 || (major == 1 && minor < 5)) {
+        return false;
+    }
+
+    XRRSelectInput(display_, root_,
+        RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+    available_ = true;
+    dirty_ = true;
+    return true;
+}
+
+bool OutputModel::handle_event(XEvent& event) {
+    if (!available_) {
+        return false;
+    }
+
+    if (event.type == event_base_ + RRScreenChangeNotify) {
+        // Keeps Xlib's idea of the screen size current
+        XRRUpdateConfiguration(&event);
+    } else if (event.type != event_base_ + RRNotify) {
+        return false;
+    }
+
+    // Any number of notifications in a batch cost one rebuild
+    dirty_ = true;
+    stats_.events++;
+    return true;
+}
+
+bool OutputModel::refresh() {
+    if (!dirty_) {
+        return false;
+    }
+    dirty_ = false;
+
+    std::vector<Output> previous;
+    previous.swap(outputs_);
+    rebuild();
+    build_lookup();
+    stats_.rebuilds++;
+
+    bool changed = previous.size() != outputs_.size();
+    for (size_t i = 0; !changed && i < outputs_.size(); ++i) {
+        changed = !(previous[i].geometry == outputs_[i].geometry) ||
+                  previous[i].name != outputs_[i].name ||
+                  previous[i].primary != outputs_[i].primary;
+    }
+    if (!changed) {
+        // Same outputs; keep their work areas
+        outputs_.swap(previous);
+        return false;
+    }
+    stats_.changes++;
+    return true;
+}
+
+bool OutputModel::set_work_area(int index, const Layout::Rect& area) {
+    Output& output = outputs_[index];
+    if (output.work_area == area) {
+        return false;
+    }
+    output.work_area = area;
+    return true;
+}
+
+void OutputModel::rebuild() {
+    primary_ = 0;
+
+    int count = 0;
+    XRRMonitorInfo* monitors = available_ ? XRRGetMonitors(display_, root_, True, &count) : nullptr;
+    for (int i = 0; i < count; ++i) {
+        const XRRMonitorInfo& monitor = monitors[i];
+        if (monitor.width <= 0 || monitor.height <= 0) {
+            continue;
+        }
+
+        Output output;
+        if (char* name = XGetAtomName(display_, monitor.name)) {
+            output.name = name;
+            XFree(name);
+        }
+        output.geometry = Layout::Rect{ monitor.x, monitor.y, monitor.width, monitor.height };
+        output.work_area = output.geometry;
+        output.primary = monitor.primary;
+        if (output.primary) {
+            primary_ = outputs_.size();
+        }
+        outputs_.push_back(output);
+    }
+    if (monitors) {
+        XRRFreeMonitors(monitors);
+    }
+
+    if (outputs_.empty()) {
+        int screen = DefaultScreen(display_);
+        Output output;
+        output.name = "default";
+        output.geometry = Layout::Rect{ 0, 0, DisplayWidth(display_, screen), DisplayHeight(display_, screen) };
+        output.work_area = output.geometry;
+        output.primary = true;
+        outputs_.push_back(output);
+    }
+}
+
+void OutputModel::build_lookup() {
+    columns_.clear();
+    rows_.clear();
+    for (const Output& output : outputs_) {
+        columns_.push_back(output.geometry.x);
+        columns_.push_back(output.geometry.x + output.geometry.width);
+        rows_.push_back(output.geometry.y);
+        rows_.push_back(output.geometry.y + output.geometry.height);
+    }
+    std::sort(columns_.begin(), columns_.end());
+    columns_.erase(std::unique(columns_.begin(), columns_.end()), columns_.end());
+    std::sort(rows_.begin(), rows_.end());
+    rows_.erase(std::unique(rows_.begin(), rows_.end()), rows_.end());
+
+    // Where outputs overlap (clones), the first listed owns the cell
+    int width = columns_.size() - 1;
+    int height = rows_.size() - 1;
+    cells_.assign(width * height, -1);
+    for (int row = 0; row < height; ++row) {
+        for (int column = 0; column < width; ++column) {
+            int x = columns_[column];
+            int y = rows_[row];
+            for (size_t i = 0; i < outputs_.size(); ++i) {
+                const Layout::Rect& geometry = outputs_[i].geometry;
+                if (x >= geometry.x && x < geometry.x + geometry.width &&
+                    y >= geometry.y && y < geometry.y + geometry.height) {
+                    cells_[row * width + column] = i;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+int OutputModel::lookup(int x, int y) const {
+    stats_.lookups++;
+    auto column = std::upper_bound(columns_.begin(), columns_.end(), x) - columns_.begin() - 1;
+    auto row = std::upper_bound(rows_.begin(), rows_.end(), y) - rows_.begin() - 1;
+    int width = columns_.size() - 1;
+    int height = rows_.size() - 1;
+    if (column < 0 || column >= width || row < 0 || row >= height) {
+        return -1;
+    }
+    return cells_[row * width + column];
+}
+
+int OutputModel::nearest(int x, int y) const {
+    int best = primary_;
+    long best_distance = LONG_MAX;
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+        const Layout::Rect& geometry = outputs_[i].geometry;
+        long dx = std::max({ geometry.x - x, 0, x - (geometry.x + geometry.width - 1) });
+        long dy = std::max({ geometry.y - y, 0, y - (geometry.y + geometry.height - 1) });
+        long distance = dx * dx + dy * dy;
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
+
+int OutputModel::find(int x, int y) const {
+    int index = lookup(x, y);
+    return index >= 0 ? index : nearest(x, y);
+}
+
+int OutputModel::find(const Layout::Rect& rect) const {
+    return find(rect.x + rect.width / 2, rect.y + rect.height / 2);
+}
+
+bool OutputModel::contains(int x, int y) const {
+    return lookup(x, y) >= 0;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,115 @@
+#ifndef MALGORO_OUTPUT_MODEL_H
+#define MALGORO_OUTPUT_MODEL_H
+
+#include <string>
+#include <vector>
+#include <X11/Xlib.h>
+#include "Layout.h"
+
+namespace MalgoroDE {
+
+/**
+ * @brief Monitor geometry from RandR
+ *
+ * Built from the RandR 1.5 monitor list, which includes the virtual
+ * monitors created with `xrandr --setmonitor`. It is only rebuilt after a
+ * screen, CRTC or output change notification, once per event batch, and
+ * is a single output covering the screen where RandR is unavailable.
+ *
+ * Lookups go through a table of the cells formed by all output edges, so
+ * finding the output at a point costs two searches over a handful of
+ * coordinates however often it is asked.
+ */
+class OutputModel {
+public:
+    struct Output {
+        std::string name;
+        Layout::Rect geometry;
+        Layout::Rect work_area;     // Geometry minus the space reserved by panels
+        bool primary = false;
+    };
+
+    struct Stats {
+        unsigned long events = 0;
+        unsigned long rebuilds = 0;
+        unsigned long changes = 0;  // Rebuilds whose geometry or primary differed
+        unsigned long lookups = 0;
+    };
+
+    OutputModel(Display* display, ::Window root);
+
+    OutputModel(const OutputModel&) = delete;
+    OutputModel& operator=(const OutputModel&) = delete;
+
+    /**
+     * @brief Check for RandR 1.5 and select its change notifications
+     * @return false if RandR is unavailable (a single output is used)
+     */
+    bool initialize();
+
+    /**
+     * @brief Note a RandR change notification
+     * @return true if the event was a RandR event
+     */
+    bool handle_event(XEvent& event);
+
+    /**
+     * @brief Rebuild the outputs if a notification arrived since the last call
+     * @return true if output geometry or the primary output changed
+     */
+    bool refresh();
+
+    const std::vector<Output>& get_outputs() const { return outputs_; }
+    const Output& get_output(int index) const { return outputs_[index]; }
+    int get_primary() const { return primary_; }
+
+    /**
+     * @brief Set an output's work area (the geometry until struts are known)
+     * @return true if it changed
+     */
+    bool set_work_area(int index, const Layout::Rect& area);
+
+    /**
+     * @brief Output containing a point, or the nearest one if none does
+     */
+    int find(int x, int y) const;
+
+    /**
+     * @brief Output containing the center of a rectangle, or the nearest
+     */
+    int find(const Layout::Rect& rect) const;
+
+    /**
+     * @brief Whether any output contains a point
+     */
+    bool contains(int x, int y) const;
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    void rebuild();
+    void build_lookup();
+    int lookup(int x, int y) const;     // -1 outside every output
+    int nearest(int x, int y) const;
+
+    Display* display_;
+    ::Window root_;
+
+    bool available_;
+    bool dirty_;
+    int event_base_;
+
+    std::vector<Output> outputs_;
+    int primary_;
+
+    // Lookup table: cell (column, row) of the output edge grid
+    std::vector<int> columns_;  // Sorted x edges
+    std::vector<int> rows_;     // Sorted y edges
+    std::vector<int> cells_;    // Output index per cell, -1 if uncovered
+
+    mutable Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_OUTPUT_MODEL_H
@@ -0,0 +1,109 @@
+#include "Placement.h"
+#include "SpatialIndex.h"
+#include "Window.h"
+#include "WindowStore.h"
+#include <algorithm>
+#include <climits>
+
+namespace MalgoroDE {
+
+void Placement::place_smart(SpatialIndex& index, WindowStore& store, int workspace,
+                            const Layout::Rect& area, int width, int height,
+                            WindowHandle exclude, int& x, int& y) {
+    auto start = std::chrono::steady_clock::now();
+
+    int columns = (area.width + CELL_SIZE - 1) / CELL_SIZE;
+    int rows = (area.height + CELL_SIZE - 1) / CELL_SIZE;
+    if (columns <= 0 || rows <= 0) {
+        x = area.x;
+        y = area.y;
+        return;
+    }
+
+    // Frame size in cells; a frame larger than the area is pinned to its edge
+    int span_x = std::clamp((width + CELL_SIZE - 1) / CELL_SIZE, 1, columns);
+    int span_y = std::clamp((height + CELL_SIZE - 1) / CELL_SIZE, 1, rows);
+
+    // Mark each obstacle as a 2D difference: +1 at its top-left cell and
+    // the corrections past its right and bottom edges. Partly covered
+    // cells count as covered.
+    int stride = columns + 1;
+    coverage_.assign(stride * (rows + 1), 0);
+    index.query(workspace, area, [&](WindowHandle handle, const Layout::Rect& rect) {
+        if (handle == exclude) {
+            return;
+        }
+        Window* window = store.get(handle);
+        if (!window || window->is_minimized() || window->is_hidden() ||
+            window->get_type() == Window::Type::DESKTOP) {
+            return;
+        }
+
+        int left = std::max(rect.x, area.x) - area.x;
+        int top = std::max(rect.y, area.y) - area.y;
+        int right = std::min(rect.x + rect.width, area.x + area.width) - area.x;
+        int bottom = std::min(rect.y + rect.height, area.y + area.height) - area.y;
+        int c0 = left / CELL_SIZE;
+        int r0 = top / CELL_SIZE;
+        int c1 = (right + CELL_SIZE - 1) / CELL_SIZE;
+        int r1 = (bottom + CELL_SIZE - 1) / CELL_SIZE;
+        coverage_[r0 * stride + c0]++;
+        coverage_[r0 * stride + c1]--;
+        coverage_[r1 * stride + c0]--;
+        coverage_[r1 * stride + c1]++;
+    });
+
+    // Integrate the differences into per-cell coverage, and the coverage
+    // into a summed-area table with a zero first row and column
+    sums_.assign(stride * (rows + 1), 0);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            int& cell = coverage_[r * stride + c];
+            if (r > 0) {
+                cell += coverage_[(r - 1) * stride + c];
+            }
+            if (c > 0) {
+                cell += coverage_[r * stride + c - 1];
+            }
+            if (r > 0 && c > 0) {
+                cell -= coverage_[(r - 1) * stride + c - 1];
+            }
+            sums_[(r + 1) * stride + c + 1] = cell + sums_[r * stride + c + 1] +
+                sums_[(r + 1) * stride + c] - sums_[r * stride + c];
+        }
+    }
+
+    // Row-major scan, so ties go to the top-most, then left-most position
+    long best = LONG_MAX;
+    int best_column = 0;
+    int best_row = 0;
+    for (int r = 0; r + span_y <= rows && best > 0; ++r) {
+        const long* above = &sums_[r * stride];
+        const long* below = &sums_[(r + span_y) * stride];
+        for (int c = 0; c + span_x <= columns; ++c) {
+            long overlap = below[c + span_x] - above[c + span_x] - below[c] + above[c];
+            if (overlap < best) {
+                best = overlap;
+                best_column = c;
+                best_row = r;
+                if (best == 0) {
+                    break;
+                }
+            }
+        }
+    }
+
+    x = std::max(area.x, std::min(area.x + best_column * CELL_SIZE, area.x + area.width - width));
+    y = std::max(area.y, std::min(area.y + best_row * CELL_SIZE, area.y + area.height - height));
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    stats_.placements++;
+    if (best > 0) {
+        stats_.overlapping++;
+    }
+    stats_.total_latency += latency;
+    stats_.max_latency = std::max(stats_.max_latency, latency);
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,55 @@
+#ifndef MALGORO_PLACEMENT_H
+#define MALGORO_PLACEMENT_H
+
+#include <chrono>
+#include <vector>
+#include "Layout.h"
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+class SpatialIndex;
+class WindowStore;
+
+/**
+ * @brief Smart placement of new windows
+ *
+ * The work area is rasterized into CELL_SIZE squares holding the number of
+ * frames covering each one, gathered with a single spatial index query.
+ * A summed-area table over that raster gives the overlap of any
+ * candidate position in constant time, so every position in the area is
+ * scored in one pass over the raster regardless of the window count.
+ */
+class Placement {
+public:
+    static const int CELL_SIZE = 16;
+
+    struct Stats {
+        unsigned long placements = 0;
+        unsigned long overlapping = 0;  // No free spot; least overlap chosen
+        std::chrono::microseconds total_latency{0};
+        std::chrono::microseconds max_latency{0};
+    };
+
+    /**
+     * @brief Find the position for a @p width x @p height frame
+     *
+     * Prefers the top-most, then left-most position where the frame covers
+     * no other visible window; failing that, the position with the least
+     * overlap. Desktop windows and @p exclude are not obstacles.
+     */
+    void place_smart(SpatialIndex& index, WindowStore& store, int workspace,
+                     const Layout::Rect& area, int width, int height,
+                     WindowHandle exclude, int& x, int& y);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    std::vector<int> coverage_;     // Scratch raster, reused between calls
+    std::vector<long> sums_;        // Summed-area table, one row/column larger
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_PLACEMENT_H
@@ -0,0 +1,132 @@
+#include "RootProperties.h"
+#include <algorithm>
+
+namespace MalgoroDE {
+
+RootPropertyPublisher::RootPropertyPublisher(Display* display, ::Window root)
+    : display_(display)
+    , root_(root)
+    , dirty_(false)
+{
+}
+
+RootPropertyPublisher::Entry& RootPropertyPublisher::entry_for(Atom property, Atom type) {
+    for (Entry& entry : entries_) {
+        if (entry.property == property) {
+            entry.type = type;
+            return entry;
+        }
+    }
+
+    Entry entry;
+    entry.property = property;
+    entry.type = type;
+    entry.appendable = false;
+    entry.staged = false;
+    entry.remove = false;
+    entry.known = false;
+    entry.present = false;
+    entries_.push_back(entry);
+    return entries_.back();
+}
+
+void RootPropertyPublisher::set_list(Atom property, Atom type,
+                                     const std::vector<unsigned long>& value,
+                                     bool appendable) {
+    Entry& entry = entry_for(property, type);
+    stats_.staged++;
+    if (entry.staged) {
+        stats_.coalesced++;
+    }
+
+    entry.appendable = appendable;
+    entry.pending.assign(value.begin(), value.end());
+    entry.remove = false;
+    entry.staged = true;
+    dirty_ = true;
+}
+
+void RootPropertyPublisher::set_value(Atom property, Atom type, unsigned long value) {
+    Entry& entry = entry_for(property, type);
+    stats_.staged++;
+    if (entry.staged) {
+        stats_.coalesced++;
+    }
+
+    entry.appendable = false;
+    entry.pending.assign(1, value);
+    entry.remove = false;
+    entry.staged = true;
+    dirty_ = true;
+}
+
+void RootPropertyPublisher::clear(Atom property) {
+    Entry& entry = entry_for(property, None);
+    stats_.staged++;
+    if (entry.staged) {
+        stats_.coalesced++;
+    }
+
+    entry.pending.clear();
+    entry.remove = true;
+    entry.staged = true;
+    dirty_ = true;
+}
+
+void RootPropertyPublisher::flush() {
+    if (!dirty_) {
+        return;
+    }
+    dirty_ = false;
+
+    for (Entry& entry : entries_) {
+        if (entry.staged) {
+            entry.staged = false;
+            write(entry);
+        }
+    }
+}
+
+void RootPropertyPublisher::write(Entry& entry) {
+    if (entry.remove) {
+        if (entry.known && !entry.present) {
+            stats_.skipped++;
+            return;
+        }
+        XDeleteProperty(display_, root_, entry.property);
+        stats_.deleted++;
+        entry.current.clear();
+        entry.known = true;
+        entry.present = false;
+        return;
+    }
+
+    // An empty list is still written: pagers take a missing
+    // _NET_CLIENT_LIST to mean the WM does not support it
+    if (entry.known && entry.present && entry.pending == entry.current) {
+        stats_.skipped++;
+        return;
+    }
+
+    size_t old_size = entry.current.size();
+    bool grew_at_end = entry.known && entry.present && entry.appendable && old_size > 0 &&
+        entry.pending.size() > old_size &&
+        std::equal(entry.current.begin(), entry.current.end(), entry.pending.begin());
+
+    if (grew_at_end) {
+        XChangeProperty(display_, root_, entry.property, entry.type, 32, PropModeAppend,
+            (unsigned char*)(entry.pending.data() + old_size),
+            entry.pending.size() - old_size);
+        stats_.appended++;
+    } else {
+        XChangeProperty(display_, root_, entry.property, entry.type, 32, PropModeReplace,
+            (unsigned char*)entry.pending.data(), entry.pending.size());
+        stats_.replaced++;
+    }
+
+    entry.current.swap(entry.pending);
+    entry.known = true;
+    entry.present = true;
+}
+
+} // namespace MalgoroDE
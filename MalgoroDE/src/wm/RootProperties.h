@@ -0,0 +1,78 @@
+#ifndef MALGORO_ROOT_PROPERTIES_H
+#define MALGORO_ROOT_PROPERTIES_H
+
+#include <vector>
+#include <X11/Xlib.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Batched, diffing writer for EWMH root window properties
+ *
+ * Setters only stage a value. flush(), called once per event batch, writes
+ * each staged property at most once: unchanged values are skipped, and
+ * appendable lists that only grew are extended with PropModeAppend.
+ * Every write wakes every pager and taskbar on the display, so the
+ * counters record how many were avoided.
+ */
+class RootPropertyPublisher {
+public:
+    struct Stats {
+        unsigned long staged = 0;       // Setter calls
+        unsigned long coalesced = 0;    // Restaged before a flush
+        unsigned long skipped = 0;      // Value equal to the published one
+        unsigned long replaced = 0;     // PropModeReplace writes
+        unsigned long appended = 0;     // PropModeAppend writes
+        unsigned long deleted = 0;      // XDeleteProperty calls
+    };
+
+    RootPropertyPublisher(Display* display, ::Window root);
+
+    /**
+     * @brief Stage a format-32 list property
+     * @param appendable Growth at the end may be sent as PropModeAppend;
+     *        EWMH allows this for lists kept in mapping order such as
+     *        _NET_CLIENT_LIST, but not for _NET_CLIENT_LIST_STACKING
+     */
+    void set_list(Atom property, Atom type, const std::vector<unsigned long>& value,
+                  bool appendable = false);
+    void set_value(Atom property, Atom type, unsigned long value);
+
+    /**
+     * @brief Stage removal of a property
+     */
+    void clear(Atom property);
+
+    /**
+     * @brief Write every staged property that changed
+     */
+    void flush();
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct Entry {
+        Atom property;
+        Atom type;
+        bool appendable;
+        bool staged;
+        bool remove;                        // Staged a clear() rather than a value
+        bool known;                         // current matches the server
+        bool present;                       // The property exists, possibly empty
+        std::vector<unsigned long> pending;
+        std::vector<unsigned long> current; // Last value written
+    };
+
+    Entry& entry_for(Atom property, Atom type);
+    void write(Entry& entry);
+
+    Display* display_;
+    ::Window root_;
+    std::vector<Entry> entries_;    // A dozen or so; scanned linearly
+    bool dirty_;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_ROOT_PROPERTIES_H
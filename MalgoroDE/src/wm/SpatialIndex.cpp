@@ -0,0 +1,148 @@
+#include "SpatialIndex.h"
+#include "Window.h"
+#include <algorithm>
+
+namespace MalgoroDE {
+
+SpatialIndex::CellRange SpatialIndex::cells_for(const Layout::Rect& rect) {
+    // Arithmetic shifts round towards negative infinity, so windows partly
+    // off the left or top of the screen land in the right cells
+    int width = std::max(1, rect.width);
+    int height = std::max(1, rect.height);
+    return CellRange{ rect.x >> CELL_SHIFT, rect.y >> CELL_SHIFT,
+                      (rect.x + width - 1) >> CELL_SHIFT, (rect.y + height - 1) >> CELL_SHIFT };
+}
+
+uint64_t SpatialIndex::cell_key(int workspace, int cx, int cy) {
+    // X coordinates are 16-bit, so cell coordinates fit in 24 bits each
+    return (static_cast<uint64_t>(static_cast<uint16_t>(workspace)) << 48) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(cx) & 0xffffff) << 24) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(cy) & 0xffffff));
+}
+
+bool SpatialIndex::intersects(const Layout::Rect& a, const Layout::Rect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+SpatialIndex::Entry* SpatialIndex::find(const Window& window) {
+    WindowHandle handle = window.get_handle();
+    if (!handle.is_valid() || handle.index >= entries_.size() ||
+        !(entries_[handle.index].handle == handle)) {
+        return nullptr;
+    }
+    return &entries_[handle.index];
+}
+
+const Layout::Rect* SpatialIndex::get_rect(const Window& window) const {
+    WindowHandle handle = window.get_handle();
+    if (!handle.is_valid() || handle.index >= entries_.size() ||
+        !(entries_[handle.index].handle == handle)) {
+        return nullptr;
+    }
+    return &entries_[handle.index].rect;
+}
+
+void SpatialIndex::link(uint32_t slot) {
+    const Entry& entry = entries_[slot];
+    for (int cy = entry.cells.y0; cy <= entry.cells.y1; ++cy) {
+        for (int cx = entry.cells.x0; cx <= entry.cells.x1; ++cx) {
+            cells_[cell_key(entry.workspace, cx, cy)].push_back(slot);
+        }
+    }
+}
+
+void SpatialIndex::unlink(uint32_t slot) {
+    const Entry& entry = entries_[slot];
+    for (int cy = entry.cells.y0; cy <= entry.cells.y1; ++cy) {
+        for (int cx = entry.cells.x0; cx <= entry.cells.x1; ++cx) {
+            auto cell = cells_.find(cell_key(entry.workspace, cx, cy));
+            if (cell == cells_.end()) {
+                continue;
+            }
+            // Cells hold a handful of windows; order within one is irrelevant
+            std::vector<uint32_t>& slots = cell->second;
+            auto it = std::find(slots.begin(), slots.end(), slot);
+            if (it != slots.end()) {
+                *it = slots.back();
+                slots.pop_back();
+            }
+            if (slots.empty()) {
+                cells_.erase(cell);
+            }
+        }
+    }
+}
+
+void SpatialIndex::insert(const Window& window, int workspace, const Layout::Rect& frame) {
+    WindowHandle handle = window.get_handle();
+    if (!handle.is_valid()) {
+        return;
+    }
+    if (find(window)) {
+        update(window, frame);
+        set_workspace(window, workspace);
+        return;
+    }
+    if (handle.index >= entries_.size()) {
+        entries_.resize(handle.index + 1);
+    }
+
+    Entry& entry = entries_[handle.index];
+    if (entry.handle.is_valid()) {
+        // A stale entry whose window was never removed
+        unlink(handle.index);
+    }
+    entry.handle = handle;
+    entry.workspace = workspace;
+    entry.rect = frame;
+    entry.cells = cells_for(frame);
+    link(handle.index);
+    stats_.inserts++;
+}
+
+void SpatialIndex::update(const Window& window, const Layout::Rect& frame) {
+    Entry* entry = find(window);
+    if (!entry || entry->rect == frame) {
+        return;
+    }
+
+    stats_.updates++;
+    entry->rect = frame;
+    CellRange cells = cells_for(frame);
+    if (cells == entry->cells) {
+        return;
+    }
+
+    uint32_t slot = entry->handle.index;
+    unlink(slot);
+    entry->cells = cells;
+    link(slot);
+    stats_.relinks++;
+}
+
+void SpatialIndex::set_workspace(const Window& window, int workspace) {
+    Entry* entry = find(window);
+    if (!entry || entry->workspace == workspace) {
+        return;
+    }
+
+    uint32_t slot = entry->handle.index;
+    unlink(slot);
+    entry->workspace = workspace;
+    link(slot);
+    stats_.relinks++;
+}
+
+void SpatialIndex::remove(const Window& window) {
+    Entry* entry = find(window);
+    if (!entry) {
+        return;
+    }
+
+    unlink(entry->handle.index);
+    entry->handle = WindowHandle();
+    entry->workspace = -1;
+}
+
+} // namespace MalgoroDE
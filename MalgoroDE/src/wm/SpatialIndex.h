@@ -0,0 +1,112 @@
+#ifndef MALGORO_SPATIAL_INDEX_H
+#define MALGORO_SPATIAL_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Layout.h"
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+class Window;
+
+/**
+ * @brief Uniform grid of frame rectangles, per workspace
+ *
+ * Each window is listed in every CELL_SIZE square its frame touches, so a
+ * query only looks at the windows near the queried area instead of every
+ * window on the workspace. Updates relink a window only when the set of
+ * cells it touches changes; a move within the same cells just rewrites
+ * its rectangle.
+ */
+class SpatialIndex {
+public:
+    static const int CELL_SHIFT = 8;
+    static const int CELL_SIZE = 1 << CELL_SHIFT;
+
+    struct Stats {
+        unsigned long inserts = 0;
+        unsigned long updates = 0;
+        unsigned long relinks = 0;      // Updates that changed cells
+        unsigned long queries = 0;
+        unsigned long candidates = 0;   // Windows looked at by queries
+    };
+
+    void insert(const Window& window, int workspace, const Layout::Rect& frame);
+    void update(const Window& window, const Layout::Rect& frame);
+    void set_workspace(const Window& window, int workspace);
+    void remove(const Window& window);
+
+    /**
+     * @brief Indexed frame rectangle of a window, or nullptr
+     */
+    const Layout::Rect* get_rect(const Window& window) const;
+
+    /**
+     * @brief Visit every window on @p workspace whose frame intersects
+     *        @p area, once each, as visit(WindowHandle, const Layout::Rect&)
+     */
+    template <typename Visitor>
+    void query(int workspace, const Layout::Rect& area, Visitor&& visit) {
+        stats_.queries++;
+        if (area.width <= 0 || area.height <= 0) {
+            return;
+        }
+
+        uint32_t serial = ++serial_;
+        CellRange range = cells_for(area);
+        for (int cy = range.y0; cy <= range.y1; ++cy) {
+            for (int cx = range.x0; cx <= range.x1; ++cx) {
+                auto cell = cells_.find(cell_key(workspace, cx, cy));
+                if (cell == cells_.end()) {
+                    continue;
+                }
+                for (uint32_t slot : cell->second) {
+                    Entry& entry = entries_[slot];
+                    if (entry.mark == serial) {
+                        continue;
+                    }
+                    entry.mark = serial;
+                    stats_.candidates++;
+                    if (intersects(entry.rect, area)) {
+                        visit(entry.handle, entry.rect);
+                    }
+                }
+            }
+        }
+    }
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct CellRange {
+        int x0, y0, x1, y1;     // Inclusive
+        bool operator==(const CellRange& other) const = default;
+    };
+
+    struct Entry {
+        WindowHandle handle;    // Invalid if the slot is unused
+        int workspace = -1;
+        Layout::Rect rect;
+        CellRange cells{};
+        uint32_t mark = 0;      // Last query that visited this entry
+    };
+
+    static CellRange cells_for(const Layout::Rect& rect);
+    static uint64_t cell_key(int workspace, int cx, int cy);
+    static bool intersects(const Layout::Rect& a, const Layout::Rect& b);
+
+    Entry* find(const Window& window);
+    void link(uint32_t slot);
+    void unlink(uint32_t slot);
+
+    std::vector<Entry> entries_;    // By WindowStore slot index
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+    uint32_t serial_ = 0;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_SPATIAL_INDEX_H
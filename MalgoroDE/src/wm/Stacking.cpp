@@ -0,0 +1,167 @@
+#include "Stacking.h"
+#include <algorithm>
+
+namespace MalgoroDE {
+
+Stacking::Stacking()
+    : dirty_(false)
+    , ranks_dirty_(false)
+{
+}
+
+Stacking::Layer Stacking::layer_for(const Window& window) {
+    if (window.get_type() == Window::Type::DESKTOP) {
+        return LAYER_DESKTOP;
+    }
+    if (window.is_fullscreen() && window.is_focused()) {
+        return LAYER_FULLSCREEN;
+    }
+    if (window.get_type() == Window::Type::DOCK) {
+        return LAYER_DOCK;
+    }
+    if (window.is_below()) {
+        return LAYER_BELOW;
+    }
+    if (window.is_above()) {
+        return LAYER_ABOVE;
+    }
+    return LAYER_NORMAL;
+}
+
+void Stacking::add(WindowStore& store, Window& window) {
+    if (LayerList::contains(window)) {
+        return;
+    }
+    window.stack_layer = layer_for(window);
+    layers_[window.stack_layer].push_front(store, window);
+    dirty_ = true;
+    ranks_dirty_ = true;
+}
+
+void Stacking::remove(WindowStore& store, Window& window) {
+    if (!LayerList::contains(window)) {
+        return;
+    }
+    layers_[window.stack_layer].remove(store, window);
+    window.stack_layer = -1;
+    dirty_ = true;
+    ranks_dirty_ = true;
+}
+
+void Stacking::raise(WindowStore& store, Window& window) {
+    if (!LayerList::contains(window)) {
+        return;
+    }
+    LayerList& layer = layers_[window.stack_layer];
+    if (layer.front() != window.get_handle()) {
+        layer.move_to_front(store, window);
+        dirty_ = true;
+        ranks_dirty_ = true;
+    }
+}
+
+void Stacking::lower(WindowStore& store, Window& window) {
+    if (!LayerList::contains(window)) {
+        return;
+    }
+    LayerList& layer = layers_[window.stack_layer];
+    if (layer.back() != window.get_handle()) {
+        layer.move_to_back(store, window);
+        dirty_ = true;
+        ranks_dirty_ = true;
+    }
+}
+
+void Stacking::update_layer(WindowStore& store, Window& window) {
+    if (!LayerList::contains(window)) {
+        return;
+    }
+    Layer layer = layer_for(window);
+    if (layer == window.stack_layer) {
+        return;
+    }
+    layers_[window.stack_layer].remove(store, window);
+    window.stack_layer = layer;
+    layers_[layer].push_front(store, window);
+    dirty_ = true;
+    ranks_dirty_ = true;
+}
+
+Window* Stacking::get_top(WindowStore& store) {
+    for (int layer = LAYER_COUNT - 1; layer >= 0; --layer) {
+        if (Window* window = store.get(layers_[layer].front())) {
+            return window;
+        }
+    }
+    return nullptr;
+}
+
+int Stacking::get_rank(WindowStore& store, const Window& window) {
+    if (ranks_dirty_) {
+        int rank = 0;
+        for_each_bottom_up(store, [&](Window& stacked) {
+            stacked.stack_rank = rank++;
+        });
+        ranks_dirty_ = false;
+    }
+    return window.stack_rank;
+}
+
+bool Stacking::commit(Display* display, WindowStore& store, std::vector<::Window>& clients) {
+    if (!dirty_) {
+        return false;
+    }
+    dirty_ = false;
+
+    order_.clear();
+    clients.clear();
+    int rank = 0;
+    for_each_bottom_up(store, [&](Window& window) {
+        order_.push_back(window.get_frame() ? window.get_frame() : window.get_xwindow());
+        clients.push_back(window.get_xwindow());
+        window.stack_rank = rank++;
+    });
+    ranks_dirty_ = false;
+
+    if (order_ == committed_) {
+        return false;
+    }
+
+    // The changed span is what remains after the common prefix and suffix;
+    // removals alone leave the server order valid and need no request
+    size_t n = order_.size();
+    size_t limit = std::min(n, committed_.size());
+    size_t prefix = 0;
+    while (prefix < limit && order_[prefix] == committed_[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           order_[n - 1 - suffix] == committed_[committed_.size() - 1 - suffix]) {
+        suffix++;
+    }
+
+    if (prefix + suffix < n) {
+        // XRestackWindows takes windows top to bottom and keeps the first
+        // in place. Anchor on the unchanged window above the span, or raise
+        // the span's top window when the span reaches the top of the stack.
+        size_t top = n - suffix;
+        restack_.clear();
+        if (top < n) {
+            restack_.push_back(order_[top]);
+        } else {
+            XRaiseWindow(display, order_[top - 1]);
+        }
+        for (size_t i = top; i-- > prefix;) {
+            restack_.push_back(order_[i]);
+        }
+        if (restack_.size() > 1) {
+            XRestackWindows(display, restack_.data(), restack_.size());
+        }
+    }
+
+    committed_.swap(order_);
+    return true;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,97 @@
+#ifndef MALGORO_STACKING_H
+#define MALGORO_STACKING_H
+
+#include <vector>
+#include <X11/Xlib.h>
+#include "HandleList.h"
+
+namespace MalgoroDE {
+
+/**
+ * @brief Layered stacking order of managed windows
+ *
+ * Each layer is an intrusive list (front = top), so raise and lower are
+ * O(1). Changes are only recorded locally; commit() sends the part of the
+ * order that changed since the last commit as one XRestackWindows call.
+ */
+class Stacking {
+public:
+    // Layers from bottom to top
+    enum Layer {
+        LAYER_DESKTOP,
+        LAYER_BELOW,
+        LAYER_NORMAL,
+        LAYER_ABOVE,
+        LAYER_DOCK,
+        LAYER_FULLSCREEN,
+        LAYER_COUNT
+    };
+
+    Stacking();
+
+    /**
+     * @brief Layer a window belongs in, from its type and state
+     */
+    static Layer layer_for(const Window& window);
+
+    void add(WindowStore& store, Window& window);
+    void remove(WindowStore& store, Window& window);
+    void raise(WindowStore& store, Window& window);
+    void lower(WindowStore& store, Window& window);
+
+    /**
+     * @brief Move a window to the top of its layer after a type/state change
+     */
+    void update_layer(WindowStore& store, Window& window);
+
+    /**
+     * @brief Topmost window in the stack, or nullptr
+     */
+    Window* get_top(WindowStore& store);
+
+    /**
+     * @brief Visit windows from bottom to top
+     */
+    template <typename Visitor>
+    void for_each_bottom_up(WindowStore& store, Visitor&& visit) {
+        for (int layer = 0; layer < LAYER_COUNT; ++layer) {
+            Window* window = store.get(layers_[layer].back());
+            while (window) {
+                visit(*window);
+                window = store.get(LayerList::prev(*window));
+            }
+        }
+    }
+
+    /**
+     * @brief Position of a window from the bottom of the stack
+     *
+     * Ranks are renumbered by the next commit or, if the order changed
+     * since, by the first call after the change.
+     */
+    int get_rank(WindowStore& store, const Window& window);
+
+    bool is_dirty() const { return dirty_; }
+
+    /**
+     * @brief Push pending stacking changes to the X server
+     * @param clients Filled with client IDs bottom to top for
+     *        _NET_CLIENT_LIST_STACKING
+     * @return true if the order differs from the last commit
+     */
+    bool commit(Display* display, WindowStore& store, std::vector<::Window>& clients);
+
+private:
+    using LayerList = HandleList<&Window::stack_link>;
+
+    LayerList layers_[LAYER_COUNT];
+    std::vector<::Window> committed_;   // Stacked IDs, bottom to top, as last sent
+    std::vector<::Window> order_;       // Scratch buffer for commit()
+    std::vector<::Window> restack_;     // Scratch buffer for commit()
+    bool dirty_;
+    bool ranks_dirty_;  // Window::stack_rank is out of date
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_STACKING_H
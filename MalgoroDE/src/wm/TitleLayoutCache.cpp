@@ -0,0 +1,78 @@
+#include "TitleLayoutCache.h"
+#include <functional>
+
+namespace MalgoroDE {
+
+size_t TitleLayoutCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = key.title_hash;
+    hash ^= std::hash<std::string>()(key.font_family) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= (static_cast<size_t>(key.width) << 16) ^ (static_cast<size_t>(key.font_size) << 1) ^ key.bold;
+    return hash;
+}
+
+TitleLayoutCache::TitleLayoutCache(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1)
+    , context_(pango_font_map_create_context(pango_cairo_font_map_get_default()))
+{
+}
+
+TitleLayoutCache::~TitleLayoutCache() {
+    clear();
+    g_object_unref(context_);
+}
+
+PangoLayout* TitleLayoutCache::get(const std::string& title, const std::string& font_family,
+                                   int font_size, bool bold, int width, int& height) {
+    Key key{ std::hash<std::string>()(title), title, font_family, font_size, bold, width };
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        stats_.hits++;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        height = it->second->height;
+        return it->second->layout;
+    }
+
+    stats_.misses++;
+    if (entries_.size() >= capacity_) {
+        Entry& oldest = entries_.back();
+        g_object_unref(oldest.layout);
+        index_.erase(oldest.key);
+        entries_.pop_back();
+        stats_.evictions++;
+    }
+
+    PangoLayout* layout = shape(key, height);
+    entries_.push_front(Entry{ key, layout, height });
+    index_.emplace(std::move(key), entries_.begin());
+    return layout;
+}
+
+void TitleLayoutCache::clear() {
+    for (Entry& entry : entries_) {
+        g_object_unref(entry.layout);
+    }
+    entries_.clear();
+    index_.clear();
+}
+
+PangoLayout* TitleLayoutCache::shape(const Key& key, int& height) {
+    PangoFontDescription* font = pango_font_description_new();
+    pango_font_description_set_family(font, key.font_family.c_str());
+    pango_font_description_set_size(font, key.font_size * PANGO_SCALE);
+    pango_font_description_set_weight(font, key.bold ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL);
+
+    PangoLayout* layout = pango_layout_new(context_);
+    pango_layout_set_font_description(layout, font);
+    pango_layout_set_width(layout, key.width * PANGO_SCALE);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+    pango_layout_set_text(layout, key.title.c_str(), key.title.size());
+    pango_font_description_free(font);
+
+    // Shapes and ellipsizes the text now, so later draws only paint glyphs
+    int width;
+    pango_layout_get_pixel_size(layout, &width, &height);
+    return layout;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,87 @@
+#ifndef MALGORO_TITLE_LAYOUT_CACHE_H
+#define MALGORO_TITLE_LAYOUT_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <pango/pangocairo.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Bounded LRU of shaped, ellipsized title layouts
+ *
+ * Layouts are keyed by title, font and available width and are created on
+ * a private Pango context, so a cached layout can be shown on any cairo
+ * context without being shaped again. Since the font is part of the key,
+ * layouts of a previous theme are never returned and simply age out.
+ */
+class TitleLayoutCache {
+public:
+    struct Stats {
+        unsigned long hits = 0;
+        unsigned long misses = 0;       // Each miss shapes one layout
+        unsigned long evictions = 0;
+    };
+
+    explicit TitleLayoutCache(size_t capacity = 64);
+    ~TitleLayoutCache();
+
+    TitleLayoutCache(const TitleLayoutCache&) = delete;
+    TitleLayoutCache& operator=(const TitleLayoutCache&) = delete;
+
+    /**
+     * @brief Get the layout of @p title ellipsized to @p width pixels
+     * @param height Set to the layout's pixel height
+     * @return Layout owned by the cache, valid until the next call
+     */
+    PangoLayout* get(const std::string& title, const std::string& font_family,
+                     int font_size, bool bold, int width, int& height);
+
+    /**
+     * @brief Drop every cached layout
+     */
+    void clear();
+
+    const Stats& get_stats() const { return stats_; }
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Key {
+        size_t title_hash;
+        std::string title;
+        std::string font_family;
+        int font_size;
+        bool bold;
+        int width;
+
+        bool operator==(const Key& other) const {
+            return title_hash == other.title_hash && width == other.width &&
+                   font_size == other.font_size && bold == other.bold &&
+                   title == other.title && font_family == other.font_family;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        PangoLayout* layout;
+        int height;
+    };
+
+    PangoLayout* shape(const Key& key, int& height);
+
+    size_t capacity_;
+    PangoContext* context_;
+    std::list<Entry> entries_;      // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_TITLE_LAYOUT_CACHE_H
@@ -1,12 +1,77 @@
 #include "Window.h"
+#include "Atoms.h"
+#include "FramePool.h"
+#include "utils/Logger.h"
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
+#include <algorithm>
+#include <climits>
 #include <cstring>
-#include <iostream>
 
 namespace MalgoroDE {
 
-Window::Window(::Window xwindow, Display* display)
+namespace {
+
+// Flat atom -> enum tables, scanned linearly (a handful of entries each)
+struct TypeEntry {
+    Atom Atoms::*atom;
+    Window::Type type;
+};
+
+const TypeEntry type_table[] = {
+    { &Atoms::net_wm_window_type_normal, Window::Type::NORMAL },
+    { &Atoms::net_wm_window_type_desktop, Window::Type::DESKTOP },
+    { &Atoms::net_wm_window_type_dock, Window::Type::DOCK },
+    { &Atoms::net_wm_window_type_toolbar, Window::Type::TOOLBAR },
+    { &Atoms::net_wm_window_type_menu, Window::Type::MENU },
+    { &Atoms::net_wm_window_type_utility, Window::Type::UTILITY },
+    { &Atoms::net_wm_window_type_splash, Window::Type::SPLASH },
+    { &Atoms::net_wm_window_type_dialog, Window::Type::DIALOG },
+};
+
+struct StateEntry {
+    Atom Atoms::*atom;
+    unsigned int bit;
+};
+
+const StateEntry state_table[] = {
+    { &Atoms::net_wm_state_modal, Window::STATE_MODAL },
+    { &Atoms::net_wm_state_sticky, Window::STATE_STICKY },
+    { &Atoms::net_wm_state_maximized_vert, Window::STATE_MAXIMIZED_VERT },
+    { &Atoms::net_wm_state_maximized_horz, Window::STATE_MAXIMIZED_HORZ },
+    { &Atoms::net_wm_state_shaded, Window::STATE_SHADED },
+    { &Atoms::net_wm_state_skip_taskbar, Window::STATE_SKIP_TASKBAR },
+    { &Atoms::net_wm_state_skip_pager, Window::STATE_SKIP_PAGER },
+    { &Atoms::net_wm_state_hidden, Window::STATE_HIDDEN },
+    { &Atoms::net_wm_state_fullscreen, Window::STATE_FULLSCREEN },
+    { &Atoms::net_wm_state_above, Window::STATE_ABOVE },
+    { &Atoms::net_wm_state_below, Window::STATE_BELOW },
+};
+
+} // namespace
+
+bool Window::lookup_type(Atom atom, Type& type) {
+    const Atoms& table = atoms();
+    for (const TypeEntry& entry : type_table) {
+        if (table.*entry.atom == atom) {
+            type = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int Window::lookup_state(Atom atom) {
+    const Atoms& table = atoms();
+    for (const StateEntry& entry : state_table) {
+        if (table.*entry.atom == atom) {
+            return entry.bit;
+        }
+    }
+    return 0;
+}
+
+Window::Window(::Window xwindow, Display* display, const WindowProperties& props)
     : display_(display)
     , xwindow_(xwindow)
     , frame_(0)
@@ -14,7 +79,9 @@ Window::Window(::Window xwindow, Display* display)
     , width_(0), height_(0)
     , old_x_(0), old_y_(0)
     , old_width_(0), old_height_(0)
-    , mapped_(false)
+    , fullscreen_x_(0), fullscreen_y_(0)
+    , fullscreen_width_(0), fullscreen_height_(0)
+    , mapped_(props.viewable)
     , minimized_(false)
     , maximized_(false)
     , fullscreen_(false)
@@ -26,10 +93,14 @@ Window::Window(::Window xwindow, Display* display)
     , focused_(false)
     , skip_taskbar_(false)
     , skip_pager_(false)
+    , accepts_input_(true)
+    , urgent_(false)
     , type_(Type::NORMAL)
     , workspace_(0)
     , supports_delete_(false)
     , supports_focus_(false)
+    , supports_sync_(false)
+    , sync_counter_(None)
     , min_width_(1), min_height_(1)
     , max_width_(INT_MAX), max_height_(INT_MAX)
     , base_width_(0), base_height_(0)
@@ -38,22 +109,8 @@ Window::Window(::Window xwindow, Display* display)
     , border_width_(1)
     , titlebar_height_(24)
 {
-    // Get initial window geometry
-    XWindowAttributes attrs;
-    if (XGetWindowAttributes(display_, xwindow_, &attrs)) {
-        x_ = attrs.x;
-        y_ = attrs.y;
-        width_ = attrs.width;
-        height_ = attrs.height;
-    }
-
-    // Update window properties
-    update_title();
-    update_class();
-    update_hints();
-    update_size_hints();
-    update_protocols();
-    update_type();
+    // Properties were fetched in one pipelined burst by the caller
+    apply_properties(props);
 }
 
 Window::~Window() {
@@ -62,7 +119,7 @@ Window::~Window() {
 
 void Window::set_geometry(int x, int y, int width, int height) {
     // Apply size hints
-    apply_size_hints(width, height);
+    constrain_size(width, height);
 
     x_ = x;
     y_ = y;
@@ -70,7 +127,7 @@ void Window::set_geometry(int x, int y, int width, int height) {
     height_ = height;
 
     // Move and resize the client window
-    XMoveResizeWindow(display_, xwindow_, 0, titlebar_height_, width_, height_);
+    XMoveResizeWindow(display_, xwindow_, border_width_, titlebar_height_, width_, height_);
 
     // Update frame if it exists
     if (frame_) {
@@ -82,6 +139,19 @@ void Window::set_geometry(int x, int y, int width, int height) {
     send_configure_notify();
 }
 
+void Window::move(int x, int y) {
+    if (x == x_ && y == y_) {
+        return;
+    }
+
+    x_ = x;
+    y_ = y;
+    XMoveWindow(display_, frame_ ? frame_ : xwindow_, x_, y_);
+
+    // ICCCM 4.1.5: a move without a resize is reported synthetically
+    send_configure_notify();
+}
+
 void Window::get_frame_geometry(int& x, int& y, int& width, int& height) const {
     x = x_;
     y = y_;
@@ -90,6 +160,9 @@ void Window::get_frame_geometry(int& x, int& y, int& width, int& height) const {
 }
 
 void Window::set_mapped(bool mapped) {
+    if (!mapped && mapped_ && !minimized_) {
+        pending_unmaps_++;
+    }
     mapped_ = mapped;
     if (mapped) {
         XMapWindow(display_, xwindow_);
@@ -105,6 +178,9 @@ void Window::set_mapped(bool mapped) {
 }
 
 void Window::set_minimized(bool minimized) {
+    if (minimized && mapped_ && !minimized_) {
+        pending_unmaps_++;
+    }
     minimized_ = minimized;
     if (minimized) {
         XUnmapWindow(display_, xwindow_);
@@ -113,31 +189,29 @@ void Window::set_minimized(bool minimized) {
         }
     } else {
         XMapWindow(display_, xwindow_);
-        if (frame_) {
+        if (frame_ && !hidden_) {
             XMapWindow(display_, frame_);
         }
     }
 }
 
-void Window::set_maximized(bool maximized) {
-    if (maximized == maximized_) {
+void Window::set_maximized(bool maximized, const Layout::Rect& area) {
+    if (!maximized && !maximized_) {
         return;
     }
 
     if (maximized) {
-        // Save current geometry
-        old_x_ = x_;
-        old_y_ = y_;
-        old_width_ = width_;
-        old_height_ = height_;
-
-        // Get screen size
-        Screen* screen = DefaultScreenOfDisplay(display_);
-        int screen_width = WidthOfScreen(screen);
-        int screen_height = HeightOfScreen(screen);
-
-        // Maximize (accounting for titlebar and borders)
-        set_geometry(0, 0, screen_width, screen_height - titlebar_height_);
+        // Save current geometry, unless only fitting to a new area
+        if (!maximized_) {
+            old_x_ = x_;
+            old_y_ = y_;
+            old_width_ = width_;
+            old_height_ = height_;
+        }
+
+        // The frame, titlebar and borders included, fills the area
+        set_geometry(area.x, area.y, area.width - 2 * border_width_,
+            area.height - titlebar_height_ - border_width_);
     } else {
         // Restore previous geometry
         set_geometry(old_x_, old_y_, old_width_, old_height_);
@@ -146,9 +220,33 @@ void Window::set_maximized(bool maximized) {
     maximized_ = maximized;
 }
 
-void Window::set_fullscreen(bool fullscreen) {
+void Window::set_fullscreen(bool fullscreen, const Layout::Rect& output) {
+    if (!fullscreen && !fullscreen_) {
+        return;
+    }
+
+    if (fullscreen) {
+        if (!fullscreen_) {
+            fullscreen_x_ = x_;
+            fullscreen_y_ = y_;
+            fullscreen_width_ = width_;
+            fullscreen_height_ = height_;
+
+            // The frame loses its decorations, so it and the client are
+            // exactly the output and nothing spills onto a neighbour
+            decorated_border_width_ = border_width_;
+            decorated_titlebar_height_ = titlebar_height_;
+            border_width_ = 0;
+            titlebar_height_ = 0;
+        }
+        set_geometry(output.x, output.y, output.width, output.height);
+    } else {
+        border_width_ = decorated_border_width_;
+        titlebar_height_ = decorated_titlebar_height_;
+        set_geometry(fullscreen_x_, fullscreen_y_, fullscreen_width_, fullscreen_height_);
+    }
+
     fullscreen_ = fullscreen;
-    // TODO: Implement fullscreen mode
 }
 
 void Window::set_shaded(bool shaded) {
@@ -162,16 +260,10 @@ void Window::set_sticky(bool sticky) {
 
 void Window::set_above(bool above) {
     above_ = above;
-    if (above) {
-        XRaiseWindow(display_, frame_ ? frame_ : xwindow_);
-    }
 }
 
 void Window::set_below(bool below) {
     below_ = below;
-    if (below) {
-        XLowerWindow(display_, frame_ ? frame_ : xwindow_);
-    }
 }
 
 void Window::set_focused(bool focused) {
@@ -181,16 +273,13 @@ void Window::set_focused(bool focused) {
 void Window::take_focus() {
     if (supports_focus_) {
         // Send WM_TAKE_FOCUS message
-        Atom wm_protocols = XInternAtom(display_, "WM_PROTOCOLS", False);
-        Atom wm_take_focus = XInternAtom(display_, "WM_TAKE_FOCUS", False);
-
         XEvent event;
         memset(&event, 0, sizeof(event));
         event.type = ClientMessage;
         event.xclient.window = xwindow_;
-        event.xclient.message_type = wm_protocols;
+        event.xclient.message_type = atoms().wm_protocols;
         event.xclient.format = 32;
-        event.xclient.data.l[0] = wm_take_focus;
+        event.xclient.data.l[0] = atoms().wm_take_focus;
         event.xclient.data.l[1] = CurrentTime;
 
         XSendEvent(display_, xwindow_, False, NoEventMask, &event);
@@ -198,38 +287,30 @@ void Window::take_focus() {
     XSetInputFocus(display_, xwindow_, RevertToPointerRoot, CurrentTime);
 }
 
-void Window::create_frame() {
+void Window::create_frame(FramePool& pool) {
     if (frame_) {
         return;  // Frame already exists
     }
 
-    // Create frame window
-    XSetWindowAttributes attrs;
-    attrs.background_pixel = WhitePixel(display_, DefaultScreen(display_));
-    attrs.border_pixel = BlackPixel(display_, DefaultScreen(display_));
-    attrs.event_mask = SubstructureRedirectMask | SubstructureNotifyMask |
-                      ButtonPressMask | ButtonReleaseMask |
-                      PointerMotionMask | ExposureMask;
-
-    frame_ = XCreateWindow(display_,
-        RootWindow(display_, DefaultScreen(display_)),
-        x_, y_,
+    // Take a pre-created frame window, or have one created
+    frame_pool_ = &pool;
+    frame_ = pool.acquire(x_, y_,
         width_ + 2 * border_width_,
-        height_ + titlebar_height_ + border_width_,
-        0,
-        CopyFromParent,
-        InputOutput,
-        CopyFromParent,
-        CWBackPixel | CWBorderPixel | CWEventMask,
-        &attrs);
+        height_ + titlebar_height_ + border_width_);
+
+    // Reparenting a viewable client unmaps and remaps it; the UnmapNotify
+    // it causes (windows adopted at startup) must not withdraw it
+    if (mapped_ && !minimized_) {
+        pending_unmaps_++;
+    }
 
     // Reparent client window to frame
-    XReparentWindow(display_, xwindow_, frame_, 0, titlebar_height_);
+    XReparentWindow(display_, xwindow_, frame_, border_width_, titlebar_height_);
 
     // Map frame
     XMapWindow(display_, frame_);
 
-    std::cout << "Created frame for window " << xwindow_ << std::endl;
+    LOG_TRACE("Created frame for window {}", xwindow_);
 }
 
 void Window::destroy_frame() {
@@ -241,11 +322,11 @@ void Window::destroy_frame() {
     ::Window root = RootWindow(display_, DefaultScreen(display_));
     XReparentWindow(display_, xwindow_, root, x_, y_);
 
-    // Destroy frame
-    XDestroyWindow(display_, frame_);
+    // Recycle frame
+    frame_pool_->release(frame_);
     frame_ = 0;
 
-    std::cout << "Destroyed frame for window " << xwindow_ << std::endl;
+    LOG_TRACE("Destroyed frame for window {}", xwindow_);
 }
 
 void Window::update_frame() {
@@ -274,6 +355,9 @@ void Window::map() {
 }
 
 void Window::unmap() {
+    if (mapped_ && !minimized_) {
+        pending_unmaps_++;
+    }
     XUnmapWindow(display_, xwindow_);
     if (frame_) {
         XUnmapWindow(display_, frame_);
@@ -281,6 +365,20 @@ void Window::unmap() {
     mapped_ = false;
 }
 
+void Window::set_hidden(bool hidden) {
+    if (hidden == hidden_) {
+        return;
+    }
+    hidden_ = hidden;
+    if (frame_ && !minimized_) {
+        if (hidden) {
+            XUnmapWindow(display_, frame_);
+        } else {
+            XMapWindow(display_, frame_);
+        }
+    }
+}
+
 void Window::raise() {
     XRaiseWindow(display_, frame_ ? frame_ : xwindow_);
 }
@@ -292,16 +390,13 @@ void Window::lower() {
 void Window::close() {
     if (supports_delete_) {
         // Send WM_DELETE_WINDOW message
-        Atom wm_protocols = XInternAtom(display_, "WM_PROTOCOLS", False);
-        Atom wm_delete = XInternAtom(display_, "WM_DELETE_WINDOW", False);
-
         XEvent event;
         memset(&event, 0, sizeof(event));
         event.type = ClientMessage;
         event.xclient.window = xwindow_;
-        event.xclient.message_type = wm_protocols;
+        event.xclient.message_type = atoms().wm_protocols;
         event.xclient.format = 32;
-        event.xclient.data.l[0] = wm_delete;
+        event.xclient.data.l[0] = atoms().wm_delete_window;
         event.xclient.data.l[1] = CurrentTime;
 
         XSendEvent(display_, xwindow_, False, NoEventMask, &event);
@@ -316,158 +411,192 @@ void Window::kill() {
     XKillClient(display_, xwindow_);
 }
 
-void Window::update_title() {
-    // Try _NET_WM_NAME first (UTF-8)
-    Atom net_wm_name = XInternAtom(display_, "_NET_WM_NAME", False);
-    Atom utf8_string = XInternAtom(display_, "UTF8_STRING", False);
-
-    Atom actual_type;
-    int actual_format;
-    unsigned long nitems, bytes_after;
-    unsigned char* prop = nullptr;
-
-    if (XGetWindowProperty(display_, xwindow_, net_wm_name,
-            0, 1024, False, utf8_string,
-            &actual_type, &actual_format,
-            &nitems, &bytes_after, &prop) == Success && prop) {
-        title_ = std::string((char*)prop);
-        XFree(prop);
-        return;
+unsigned int Window::apply_properties(const WindowProperties& props) {
+    unsigned int changed = 0;
+
+    if (props.fields & WindowProperties::ATTRIBUTES) {
+        x_ = props.x;
+        y_ = props.y;
+        width_ = props.width;
+        height_ = props.height;
     }
 
-    // Fall back to WM_NAME
-    XTextProperty text_prop;
-    if (XGetWMName(display_, xwindow_, &text_prop)) {
-        if (text_prop.value) {
-            title_ = std::string((char*)text_prop.value);
-            XFree(text_prop.value);
+    if (props.fields & WindowProperties::TITLE) {
+        if (title_ != props.title) {
+            title_ = props.title;
+            changed |= WindowProperties::TITLE;
         }
-    } else {
-        title_ = "Untitled";
     }
-}
 
-void Window::update_class() {
-    XClassHint class_hint;
-    if (XGetClassHint(display_, xwindow_, &class_hint)) {
-        if (class_hint.res_class) {
-            class_name_ = std::string(class_hint.res_class);
-            XFree(class_hint.res_class);
+    if (props.fields & WindowProperties::CLASS) {
+        if (class_name_ != props.class_name || instance_ != props.instance) {
+            class_name_ = props.class_name;
+            instance_ = props.instance;
+            changed |= WindowProperties::CLASS;
+        }
+    }
+
+    if (props.fields & WindowProperties::HINTS) {
+        if (accepts_input_ != props.accepts_input || urgent_ != props.urgent) {
+            accepts_input_ = props.accepts_input;
+            urgent_ = props.urgent;
+            changed |= WindowProperties::HINTS;
         }
-        if (class_hint.res_name) {
-            instance_ = std::string(class_hint.res_name);
-            XFree(class_hint.res_name);
+    }
+
+    if (props.fields & WindowProperties::SIZE_HINTS) {
+        // Hints missing from the property fall back to their defaults
+        bool min = props.size_flags & PMinSize;
+        bool max = props.size_flags & PMaxSize;
+        bool base = props.size_flags & PBaseSize;
+        bool inc = props.size_flags & PResizeInc;
+        bool aspect = (props.size_flags & PAspect) && props.min_aspect_y && props.max_aspect_y;
+
+        int min_width = min ? std::max(props.min_width, 1) : 1;
+        int min_height = min ? std::max(props.min_height, 1) : 1;
+        int max_width = max && props.max_width > 0 ? props.max_width : INT_MAX;
+        int max_height = max && props.max_height > 0 ? props.max_height : INT_MAX;
+        int base_width = base ? props.base_width : 0;
+        int base_height = base ? props.base_height : 0;
+        int width_inc = inc && props.width_inc > 0 ? props.width_inc : 1;
+        int height_inc = inc && props.height_inc > 0 ? props.height_inc : 1;
+        float min_aspect = aspect ? (float)props.min_aspect_x / props.min_aspect_y : 0.0f;
+        float max_aspect = aspect ? (float)props.max_aspect_x / props.max_aspect_y : 0.0f;
+
+        if (min_width != min_width_ || min_height != min_height_ ||
+            max_width != max_width_ || max_height != max_height_ ||
+            base_width != base_width_ || base_height != base_height_ ||
+            width_inc != width_inc_ || height_inc != height_inc_ ||
+            min_aspect != min_aspect_ || max_aspect != max_aspect_) {
+            min_width_ = min_width;
+            min_height_ = min_height;
+            max_width_ = max_width;
+            max_height_ = max_height;
+            base_width_ = base_width;
+            base_height_ = base_height;
+            width_inc_ = width_inc;
+            height_inc_ = height_inc;
+            min_aspect_ = min_aspect;
+            max_aspect_ = max_aspect;
+            changed |= WindowProperties::SIZE_HINTS;
         }
     }
-}
 
-void Window::update_hints() {
-    XWMHints* hints = XGetWMHints(display_, xwindow_);
-    if (hints) {
-        // Process hints
-        XFree(hints);
+    if (props.fields & WindowProperties::PROTOCOLS) {
+        if (supports_delete_ != props.supports_delete ||
+            supports_focus_ != props.supports_take_focus ||
+            supports_sync_ != props.supports_sync_request) {
+            supports_delete_ = props.supports_delete;
+            supports_focus_ = props.supports_take_focus;
+            supports_sync_ = props.supports_sync_request;
+            changed |= WindowProperties::PROTOCOLS;
+        }
     }
-}
 
-void Window::update_size_hints() {
-    XSizeHints hints;
-    long supplied;
+    if (props.fields & WindowProperties::SYNC_COUNTER) {
+        if (sync_counter_ != props.sync_counter) {
+            sync_counter_ = props.sync_counter;
+            changed |= WindowProperties::SYNC_COUNTER;
+        }
+    }
 
-    if (XGetWMNormalHints(display_, xwindow_, &hints, &supplied)) {
-        if (hints.flags & PMinSize) {
-            min_width_ = hints.min_width;
-            min_height_ = hints.min_height;
+    if (props.fields & WindowProperties::STATE) {
+        unsigned int state = 0;
+        for (Atom atom : props.state) {
+            state |= lookup_state(atom);
         }
-        if (hints.flags & PMaxSize) {
-            max_width_ = hints.max_width;
-            max_height_ = hints.max_height;
+
+        // Passive flags are taken as-is; geometry-changing states
+        // (maximized, fullscreen, shaded, hidden) are applied by the WM
+        bool modal = state & STATE_MODAL;
+        bool sticky = state & STATE_STICKY;
+        bool skip_taskbar = state & STATE_SKIP_TASKBAR;
+        bool skip_pager = state & STATE_SKIP_PAGER;
+        bool above = state & STATE_ABOVE;
+        bool below = state & STATE_BELOW;
+
+        if (modal != modal_ || sticky != sticky_ ||
+            skip_taskbar != skip_taskbar_ || skip_pager != skip_pager_ ||
+            above != above_ || below != below_) {
+            modal_ = modal;
+            sticky_ = sticky;
+            skip_taskbar_ = skip_taskbar;
+            skip_pager_ = skip_pager;
+            above_ = above;
+            below_ = below;
+            changed |= WindowProperties::STATE;
         }
-        if (hints.flags & PBaseSize) {
-            base_width_ = hints.base_width;
-            base_height_ = hints.base_height;
+    }
+
+    if (props.fields & WindowProperties::STRUT) {
+        if (!(strut_ == props.strut)) {
+            strut_ = props.strut;
+            changed |= WindowProperties::STRUT;
         }
-        if (hints.flags & PResizeInc) {
-            width_inc_ = hints.width_inc;
-            height_inc_ = hints.height_inc;
+    }
+
+    if (props.fields & WindowProperties::TYPE) {
+        // _NET_WM_WINDOW_TYPE is in order of preference; use the first known type
+        Type type = Type::NORMAL;
+        for (Atom atom : props.types) {
+            if (lookup_type(atom, type)) {
+                break;
+            }
         }
-        if (hints.flags & PAspect) {
-            min_aspect_ = (float)hints.min_aspect.x / hints.min_aspect.y;
-            max_aspect_ = (float)hints.max_aspect.x / hints.max_aspect.y;
+        if (type != type_) {
+            type_ = type;
+            changed |= WindowProperties::TYPE;
         }
     }
+
+    return changed;
 }
 
-void Window::update_protocols() {
-    Atom* protocols = nullptr;
-    int count = 0;
+void Window::refresh_properties(unsigned int fields) {
+    WindowProperties props;
+    PropertyFetch fetch(display_, xwindow_, fields);
+    if (fetch.collect(props)) {
+        apply_properties(props);
+    }
+}
 
-    Atom wm_protocols = XInternAtom(display_, "WM_PROTOCOLS", False);
+void Window::update_title() {
+    refresh_properties(WindowProperties::TITLE);
+}
 
-    if (XGetWMProtocols(display_, xwindow_, &protocols, &count)) {
-        Atom wm_delete = XInternAtom(display_, "WM_DELETE_WINDOW", False);
-        Atom wm_take_focus = XInternAtom(display_, "WM_TAKE_FOCUS", False);
+void Window::update_class() {
+    refresh_properties(WindowProperties::CLASS);
+}
 
-        for (int i = 0; i < count; ++i) {
-            if (protocols[i] == wm_delete) {
-                supports_delete_ = true;
-            }
-            if (protocols[i] == wm_take_focus) {
-                supports_focus_ = true;
-            }
-        }
+void Window::update_hints() {
+    refresh_properties(WindowProperties::HINTS);
+}
 
-        XFree(protocols);
-    }
+void Window::update_size_hints() {
+    refresh_properties(WindowProperties::SIZE_HINTS);
+}
+
+void Window::update_protocols() {
+    refresh_properties(WindowProperties::PROTOCOLS);
 }
 
 void Window::update_state() {
-    // TODO: Read _NET_WM_STATE property
+    refresh_properties(WindowProperties::STATE);
 }
 
 void Window::update_type() {
-    Atom net_wm_window_type = XInternAtom(display_, "_NET_WM_WINDOW_TYPE", False);
-
-    Atom actual_type;
-    int actual_format;
-    unsigned long nitems, bytes_after;
-    unsigned char* prop = nullptr;
-
-    if (XGetWindowProperty(display_, xwindow_, net_wm_window_type,
-            0, 1, False, XA_ATOM,
-            &actual_type, &actual_format,
-            &nitems, &bytes_after, &prop) == Success && prop) {
-
-        Atom window_type = *(Atom*)prop;
-
-        Atom type_desktop = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_DESKTOP", False);
-        Atom type_dock = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_DOCK", False);
-        Atom type_toolbar = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_TOOLBAR", False);
-        Atom type_menu = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_MENU", False);
-        Atom type_utility = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_UTILITY", False);
-        Atom type_splash = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_SPLASH", False);
-        Atom type_dialog = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_DIALOG", False);
-
-        if (window_type == type_desktop) {
-            type_ = Type::DESKTOP;
-        } else if (window_type == type_dock) {
-            type_ = Type::DOCK;
-        } else if (window_type == type_toolbar) {
-            type_ = Type::TOOLBAR;
-        } else if (window_type == type_menu) {
-            type_ = Type::MENU;
-        } else if (window_type == type_utility) {
-            type_ = Type::UTILITY;
-        } else if (window_type == type_splash) {
-            type_ = Type::SPLASH;
-        } else if (window_type == type_dialog) {
-            type_ = Type::DIALOG;
-        }
+    refresh_properties(WindowProperties::TYPE);
+}
 
-        XFree(prop);
+void Window::constrain_size(int& width, int& height) const {
+    // Apply maximum size
+    if (width > max_width_) {
+        width = max_width_;
+    }
+    if (height > max_height_) {
+        height = max_height_;
     }
-}
 
-void Window::apply_size_hints(int& width, int& height) {
     // Apply minimum size
     if (width < min_width_) {
         width = min_width_;
@@ -476,20 +605,21 @@ void Window::apply_size_hints(int& width, int& height) {
         height = min_height_;
     }
 
-    // Apply maximum size
-    if (width > max_width_) {
-        width = max_width_;
-    }
-    if (height > max_height_) {
-        height = max_height_;
-    }
-
-    // Apply size increments
+    // Apply size increments. Rounding always goes down from the clamped
+    // size, stepping back up one increment if that undershot the minimum,
+    // so the same request always yields the same size (no jitter while a
+    // resize is dragged back and forth across a step)
     if (width_inc_ > 1) {
-        width = base_width_ + ((width - base_width_) / width_inc_) * width_inc_;
+        width = base_width_ + (std::max(width - base_width_, 0) / width_inc_) * width_inc_;
+        if (width < min_width_) {
+            width += width_inc_;
+        }
     }
     if (height_inc_ > 1) {
-        height = base_height_ + ((height - base_height_) / height_inc_) * height_inc_;
+        height = base_height_ + (std::max(height - base_height_, 0) / height_inc_) * height_inc_;
+        if (height < min_height_) {
+            height += height_inc_;
+        }
     }
 }
 
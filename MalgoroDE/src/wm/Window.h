@@ -4,23 +4,47 @@
 #include <string>
 #include <X11/Xlib.h>
 #include <memory>
+#include "Layout.h"
+#include "WindowHandle.h"
+#include "WindowProperties.h"
 
 namespace MalgoroDE {
 
+class FramePool;
+
 /**
  * @brief Represents a managed window
  */
 class Window {
 public:
-    Window(::Window xwindow, Display* display);
+    Window(::Window xwindow, Display* display, const WindowProperties& props);
     ~Window();
 
+    // Store handle
+    WindowHandle get_handle() const { return handle_; }
+    void set_handle(WindowHandle handle) { handle_ = handle; }
+
     // Window properties
     ::Window get_xwindow() const { return xwindow_; }
     ::Window get_frame() const { return frame_; }
-    std::string get_title() const { return title_; }
-    std::string get_class() const { return class_name_; }
-    std::string get_instance() const { return instance_; }
+    const std::string& get_title() const { return title_; }
+    /**
+     * @brief Title as displayed, e.g. "Terminal <2>" for a duplicate
+     */
+    const std::string& get_visible_title() const { return visible_name_.empty() ? title_ : visible_name_; }
+    const std::string& get_visible_name() const { return visible_name_; }   // Empty if the title is shown as-is
+    void set_visible_name(const std::string& name) { visible_name_ = name; }
+
+    // Title and suffix number the window is counted under among duplicates
+    // (0 until numbered; 1 is the plain title)
+    const std::string& get_numbered_title() const { return numbered_title_; }
+    size_t get_title_number() const { return title_number_; }
+    void set_title_number(const std::string& title, size_t number) {
+        numbered_title_ = title;
+        title_number_ = number;
+    }
+    const std::string& get_class() const { return class_name_; }
+    const std::string& get_instance() const { return instance_; }
 
     // Geometry
     int get_x() const { return x_; }
@@ -28,6 +52,7 @@ public:
     int get_width() const { return width_; }
     int get_height() const { return height_; }
     void set_geometry(int x, int y, int width, int height);
+    void move(int x, int y);    // Frame only; the client gets a synthetic ConfigureNotify
     void get_frame_geometry(int& x, int& y, int& width, int& height) const;
 
     // State
@@ -42,14 +67,27 @@ public:
     bool is_modal() const { return modal_; }
     bool is_skip_taskbar() const { return skip_taskbar_; }
     bool is_skip_pager() const { return skip_pager_; }
+    bool accepts_input() const { return accepts_input_; }
+    bool is_urgent() const { return urgent_; }
 
     void set_mapped(bool mapped);
     void set_minimized(bool minimized);
-    void set_maximized(bool maximized);
-    void set_fullscreen(bool fullscreen);
+    /**
+     * @brief Maximize the frame to fill @p area, or restore it
+     *
+     * Maximizing an already maximized window fits it to the new area and
+     * keeps the geometry saved for restoring.
+     */
+    void set_maximized(bool maximized, const Layout::Rect& area);
+
+    /**
+     * @brief Cover @p output with the client in an undecorated frame, or
+     *        restore it and its decorations; refits like set_maximized()
+     */
+    void set_fullscreen(bool fullscreen, const Layout::Rect& output);
     void set_shaded(bool shaded);
     void set_sticky(bool sticky);
-    void set_above(bool above);
+    void set_above(bool above);         // Restacking is done by the WM
     void set_below(bool below);
 
     // Focus
@@ -71,12 +109,53 @@ public:
     Type get_type() const { return type_; }
     void set_type(Type type) { type_ = type; }
 
+    // _NET_WM_STATE values as bits
+    enum StateBit : unsigned int {
+        STATE_MODAL = 1 << 0,
+        STATE_STICKY = 1 << 1,
+        STATE_MAXIMIZED_VERT = 1 << 2,
+        STATE_MAXIMIZED_HORZ = 1 << 3,
+        STATE_SHADED = 1 << 4,
+        STATE_SKIP_TASKBAR = 1 << 5,
+        STATE_SKIP_PAGER = 1 << 6,
+        STATE_HIDDEN = 1 << 7,
+        STATE_FULLSCREEN = 1 << 8,
+        STATE_ABOVE = 1 << 9,
+        STATE_BELOW = 1 << 10
+    };
+
+    /**
+     * @brief Map an atom to a window type using the shared atom table
+     * @return false if the atom is not a known window type
+     */
+    static bool lookup_type(Atom atom, Type& type);
+
+    /**
+     * @brief Map a _NET_WM_STATE atom to its StateBit (0 if unknown)
+     */
+    static unsigned int lookup_state(Atom atom);
+
     // Workspace
     int get_workspace() const { return workspace_; }
     void set_workspace(int workspace) { workspace_ = workspace; }
 
-    // Frame management
-    void create_frame();
+    /**
+     * @brief Hide or show the window for a workspace switch
+     *
+     * Only the frame is unmapped; the client stays mapped inside it, so
+     * no UnmapNotify reaches the client and it is not withdrawn.
+     */
+    void set_hidden(bool hidden);
+    bool is_hidden() const { return hidden_; }
+
+    /**
+     * @brief Consume one UnmapNotify caused by the WM unmapping the client
+     * @return true if the event was expected and must be ignored
+     */
+    bool consume_unmap() { return pending_unmaps_ > 0 && pending_unmaps_-- > 0; }
+
+    // Frame management; the frame goes back to @p pool when destroyed
+    void create_frame(FramePool& pool);
     void destroy_frame();
     void update_frame();
     void redraw_frame();
@@ -90,6 +169,17 @@ public:
     void kill();
 
     // Properties
+    /**
+     * @brief Apply fetched properties
+     * @return WindowProperties::Field bits whose values actually changed
+     */
+    unsigned int apply_properties(const WindowProperties& props);
+    void refresh_properties(unsigned int fields);
+
+    // Properties with a pending PropertyNotify, refreshed at end of batch
+    unsigned int get_dirty_properties() const { return dirty_properties_; }
+    void mark_properties_dirty(unsigned int fields) { dirty_properties_ |= fields; }
+    void clear_dirty_properties() { dirty_properties_ = 0; }
     void update_title();
     void update_class();
     void update_hints();
@@ -101,6 +191,8 @@ public:
     // Protocols
     bool supports_delete_window() const { return supports_delete_; }
     bool supports_take_focus() const { return supports_focus_; }
+    bool supports_sync_request() const { return supports_sync_ && sync_counter_ != None; }
+    XID get_sync_counter() const { return sync_counter_; }
 
     // Size constraints
     int get_min_width() const { return min_width_; }
@@ -112,23 +204,43 @@ public:
     int get_width_inc() const { return width_inc_; }
     int get_height_inc() const { return height_inc_; }
 
+    /**
+     * @brief Clamp a client size to the min/max hints and round it to the
+     * resize increments
+     */
+    void constrain_size(int& width, int& height) const;
+
+    // Reserved screen space, for docks and panels
+    const Strut& get_strut() const { return strut_; }
+
     // Frame extents
     int get_border_width() const { return border_width_; }
     int get_titlebar_height() const { return titlebar_height_; }
 
+    // Intrusive list links, maintained by the structures that own the lists
+    WindowLink stack_link;      // Stacking: position within its layer
+    WindowLink workspace_link;  // Workspace: membership, most recently used first
+    int stack_layer = -1;       // Stacking: layer, or -1 if not stacked
+    int stack_rank = 0;         // Stacking: position from the bottom, see get_rank()
+
 private:
-    void apply_size_hints(int& width, int& height);
     void send_configure_notify();
 
     Display* display_;
+    WindowHandle handle_;   // Slot in the WindowStore
     ::Window xwindow_;      // Client window
     ::Window frame_;        // Frame window (decoration)
+    FramePool* frame_pool_ = nullptr;
 
     // Geometry
     int x_, y_;
     int width_, height_;
     int old_x_, old_y_;     // Pre-maximize geometry
     int old_width_, old_height_;
+    int fullscreen_x_, fullscreen_y_;  // Pre-fullscreen geometry
+    int fullscreen_width_, fullscreen_height_;
+    int decorated_border_width_ = 0;    // Decoration sizes while fullscreen
+    int decorated_titlebar_height_ = 0;
 
     // State flags
     bool mapped_;
@@ -143,17 +255,28 @@ private:
     bool focused_;
     bool skip_taskbar_;
     bool skip_pager_;
+    bool accepts_input_;
+    bool urgent_;
+    bool hidden_ = false;       // Frame unmapped: on another workspace
+    int pending_unmaps_ = 0;    // Client unmaps issued by the WM, not yet reported
+    unsigned int dirty_properties_ = 0;
 
     // Properties
     std::string title_;
+    std::string visible_name_;  // Published as _NET_WM_VISIBLE_NAME when set
+    std::string numbered_title_;
+    size_t title_number_ = 0;
     std::string class_name_;
     std::string instance_;
     Type type_;
     int workspace_;
+    Strut strut_;
 
     // Protocols
     bool supports_delete_;
     bool supports_focus_;
+    bool supports_sync_;
+    XID sync_counter_;
 
     // Size hints
     int min_width_, min_height_;
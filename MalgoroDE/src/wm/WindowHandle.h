@@ -0,0 +1,35 @@
+#ifndef MALGORO_WINDOW_HANDLE_H
+#define MALGORO_WINDOW_HANDLE_H
+
+#include <cstdint>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Generational handle to a managed window
+ *
+ * A handle stays safe to hold after its window is unmanaged: the slot's
+ * generation changes, so resolving a stale handle yields nullptr.
+ */
+struct WindowHandle {
+    static constexpr uint32_t INVALID_INDEX = 0xffffffffu;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool is_valid() const { return index != INVALID_INDEX; }
+    bool operator==(const WindowHandle& other) const = default;
+};
+
+/**
+ * @brief Intrusive doubly-linked list link embedded in a Window record
+ */
+struct WindowLink {
+    WindowHandle prev;
+    WindowHandle next;
+    bool linked = false;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_WINDOW_HANDLE_H
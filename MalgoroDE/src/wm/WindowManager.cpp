@@ -1,16 +1,35 @@
 #include "WindowManager.h"
+#include "Atoms.h"
 #include "Window.h"
 #include "Workspace.h"
 #include "Decorator.h"
+#include "WindowProperties.h"
+#include "RootProperties.h"
+#include "MoveResize.h"
+#include "WindowSwitcher.h"
+#include "Compositor.h"
+#include "OutputModel.h"
+#include "utils/Logger.h"
+#include <X11/Xatom.h>
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
 #include <algorithm>
+#include <chrono>
+#include <poll.h>
 
 namespace MalgoroDE {
 
 // Static error handler flag
 static bool wm_detected = false;
 
+// Upper bound on events drained per batch, so a flood cannot starve dispatch
+static const size_t MAX_EVENT_BATCH = 1024;
+
+// Event type used to mark batch entries superseded by a later event.
+// Real X events start at KeyPress (2), so 0 never occurs in the queue.
+static const int COLLAPSED_EVENT = 0;
+
 WindowManager::WindowManager()
     : display_(nullptr)
     , root_(0)
@@ -46,21 +65,42 @@ bool WindowManager::initialize() {
         return false;
     }
 
-    // Initialize X11 atoms
-    init_atoms();
+    // Intern every atom the WM uses in a single round trip
+    intern_atoms(display_);
+
+    // Root properties are diffed and written once per event batch
+    root_properties_ = std::make_unique<RootPropertyPublisher>(display_, root_);
 
     // Setup EWMH and ICCCM
     setup_ewmh();
     setup_icccm();
 
     // Initialize decorator
-    decorator_ = std::make_unique<Decorator>(this);
+    decorator_ = std::make_unique<Decorator>(display_);
+
+    // Interactive move/resize, paced by XSync where the server supports it
+    move_resize_ = std::make_unique<MoveResize>(display_, root_);
+    if (!move_resize_->init_sync()) {
+        std::cerr << "XSync unavailable; resizes will not be paced" << std::endl;
+    }
+    move_resize_->set_snapping(&snap_edges_);
+
+    // Monitor geometry, rebuilt only when RandR reports a change
+    outputs_ = std::make_unique<OutputModel>(display_, root_);
+    if (!outputs_->initialize()) {
+        std::cerr << "RandR 1.5 unavailable; treating the screen as one output" << std::endl;
+    }
+    outputs_->refresh();
+
+    // Alt+Tab switcher
+    switcher_ = std::make_unique<WindowSwitcher>(display_, root_);
 
     // Initialize workspaces
     for (int i = 0; i < num_workspaces_; ++i) {
         auto workspace = std::make_shared<Workspace>(i, "Workspace " + std::to_string(i + 1));
         workspaces_.push_back(workspace);
     }
+    workspaces_[current_workspace_]->set_active(true);
 
     // Grab keyboard shortcuts
     grab_keys();
@@ -68,9 +108,31 @@ bool WindowManager::initialize() {
     // Grab mouse buttons for window management
     grab_buttons();
 
+    // Redirect and composite in-process; must precede the scan so frames
+    // created for existing windows are tracked from the start
+    if (enable_compositor_) {
+        compositor_ = std::make_unique<Compositor>(display_, screen_, root_);
+        if (!compositor_->initialize()) {
+            std::cerr << "Compositing extensions unavailable; compositor disabled" << std::endl;
+            compositor_.reset();
+        }
+    }
+    apply_outputs();
+
+    // Frames are taken from a pool, so the first windows find it filled
+    frame_pool_ = std::make_unique<FramePool>(display_, screen_);
+    frame_pool_->set_composited(compositor_ != nullptr);
+    frame_pool_->refill();
+
     // Scan for existing windows
     scan_existing_windows();
 
+    // Work areas from the struts of docks found by the scan
+    if (compute_work_areas()) {
+        on_outputs_changed();
+    }
+    root_properties_->flush();
+
     running_ = true;
     std::cout << "Window manager initialized successfully" << std::endl;
 
@@ -85,17 +147,352 @@ int WindowManager::run() {
 
     std::cout << "Starting event loop..." << std::endl;
 
-    // Main event loop
+    // Main event loop: block for one event, then drain everything already
+    // queued so it can be coalesced and dispatched as a single batch
     while (running_) {
+        // Top up the frame pool while nothing is waiting to be handled
+        if (frame_pool_->needs_refill() && !XPending(display_)) {
+            frame_pool_->refill();
+            XFlush(display_);
+        }
+
+        // Between events, wake up for the next compositor frame, or when a
+        // resize held back for an unanswered sync request is due anyway
+        int timeout = compositor_ ? compositor_->get_repaint_delay() : -1;
+        int sync_delay = move_resize_->get_flush_delay();
+        if (sync_delay >= 0 && (timeout < 0 || sync_delay < timeout)) {
+            timeout = sync_delay;
+        }
+        if (timeout >= 0 && !wait_for_events(timeout)) {
+            move_resize_->flush(windows_);
+            paint_frame();
+            root_properties_->flush();
+            XFlush(display_);
+            continue;
+        }
+
         XEvent event;
         XNextEvent(display_, &event);
-        handle_event(event);
+        batch_start_ = std::chrono::steady_clock::now();
+
+        event_batch_.clear();
+        event_batch_.push_back(event);
+        while (event_batch_.size() < MAX_EVENT_BATCH && XPending(display_)) {
+            XNextEvent(display_, &event);
+            event_batch_.push_back(event);
+        }
+
+        process_event_batch();
     }
 
     std::cout << "Event loop terminated" << std::endl;
     return 0;
 }
 
+bool WindowManager::wait_for_events(int timeout_ms) {
+    // XPending also flushes the output buffer before we sleep
+    if (XPending(display_)) {
+        return true;
+    }
+
+    struct pollfd fd;
+    fd.fd = ConnectionNumber(display_);
+    fd.events = POLLIN;
+    fd.revents = 0;
+    return poll(&fd, 1, timeout_ms) > 0;
+}
+
+void WindowManager::process_event_batch() {
+    event_stats_.batches++;
+    event_stats_.received += event_batch_.size();
+    event_stats_.largest_batch = std::max<unsigned long>(
+        event_stats_.largest_batch, event_batch_.size());
+
+    coalesce_event_batch();
+
+    for (auto& event : event_batch_) {
+        if (event.type == COLLAPSED_EVENT) {
+            continue;
+        }
+        event_stats_.dispatched++;
+        handle_event(event);
+        if (!running_) {
+            break;
+        }
+    }
+
+    finish_event_batch();
+
+    if (!adopted_windows_.empty() && event_stats_.received >= adoption_events_) {
+        check_adopted_windows();
+    }
+}
+
+void WindowManager::coalesce_event_batch() {
+    seen_motion_.clear();
+    seen_configure_.clear();
+    seen_property_.clear();
+
+    // Walk the batch backwards so the newest event of each kind is the one
+    // kept; older duplicates are marked collapsed and skipped on dispatch.
+    // Surviving events stay at their original position, so ordering relative
+    // to map/unmap/destroy events is preserved.
+    for (size_t i = event_batch_.size(); i-- > 0;) {
+        XEvent& event = event_batch_[i];
+
+        switch (event.type) {
+            case MotionNotify:
+                if (!seen_motion_.insert(event.xmotion.window).second) {
+                    event.type = COLLAPSED_EVENT;
+                    event_stats_.motion_collapsed++;
+                }
+                break;
+
+            case ButtonPress:
+            case ButtonRelease:
+                // Motion on either side of a button transition is meaningful
+                seen_motion_.clear();
+                break;
+
+            case ConfigureRequest: {
+                XConfigureRequestEvent& older = event.xconfigurerequest;
+                auto it = seen_configure_.find(older.window);
+                if (it == seen_configure_.end()) {
+                    seen_configure_.emplace(older.window, i);
+                    break;
+                }
+
+                // Fold fields only the older request carried into the newer one
+                XConfigureRequestEvent& newer = event_batch_[it->second].xconfigurerequest;
+                unsigned long missing = older.value_mask & ~newer.value_mask;
+                if (missing & CWX) newer.x = older.x;
+                if (missing & CWY) newer.y = older.y;
+                if (missing & CWWidth) newer.width = older.width;
+                if (missing & CWHeight) newer.height = older.height;
+                if (missing & CWBorderWidth) newer.border_width = older.border_width;
+                if (missing & CWSibling) newer.above = older.above;
+                if (missing & CWStackMode) newer.detail = older.detail;
+                newer.value_mask |= missing;
+
+                event.type = COLLAPSED_EVENT;
+                event_stats_.configure_collapsed++;
+                break;
+            }
+
+            case PropertyNotify: {
+                unsigned long long key =
+                    (static_cast<unsigned long long>(event.xproperty.window) << 32) |
+                    static_cast<unsigned long long>(event.xproperty.atom);
+                if (!seen_property_.insert(key).second) {
+                    event.type = COLLAPSED_EVENT;
+                    event_stats_.property_collapsed++;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void WindowManager::finish_event_batch() {
+    // Property changes may update struts, so they come first
+    refresh_dirty_properties();
+
+    // However many RandR notifications arrived, the outputs are rebuilt
+    // once; work areas only when the outputs or a strut changed
+    bool outputs_changed = outputs_->refresh();
+    if (outputs_changed) {
+        work_areas_.invalidate();
+    }
+    bool areas_changed = work_areas_.is_dirty() && compute_work_areas();
+    if (outputs_changed || areas_changed) {
+        on_outputs_changed();
+    }
+
+    // Pointer motion seen in this batch becomes at most one configure
+    move_resize_->flush(windows_);
+    commit_stacking();
+
+    // Busy event streams must not hold frames back
+    paint_frame();
+
+    root_properties_->flush();
+
+    // One flush per batch instead of one per request
+    XFlush(display_);
+}
+
+void WindowManager::paint_frame() {
+    if (!compositor_) {
+        return;
+    }
+
+    if (compositor_->paint_if_due()) {
+        frame_pool_->note_presented();
+        if (switch_pending_ && switch_unmapped_.empty()) {
+            record_switch();
+        }
+    }
+
+    // Publish the windows bypassing the compositor, so benchmarks can
+    // check that full-screen workloads are not composited
+    if (compositor_->get_unredirect_serial() != unredirect_serial_) {
+        unredirect_serial_ = compositor_->get_unredirect_serial();
+        std::vector<::Window> clients;
+        for (::Window toplevel : compositor_->get_unredirected()) {
+            Window* window = find_window(toplevel);
+            clients.push_back(window ? window->get_xwindow() : toplevel);
+        }
+        root_properties_->set_list(atoms().malgoro_unredirected, XA_WINDOW, clients);
+    }
+}
+
+void WindowManager::print_stats() const {
+    const EventStats& stats = event_stats_;
+    unsigned long collapsed = stats.motion_collapsed +
+        stats.configure_collapsed + stats.property_collapsed;
+
+    std::cout << "Event loop statistics:" << std::endl;
+    std::cout << "  Batches: " << stats.batches
+              << " (largest " << stats.largest_batch << " events)" << std::endl;
+    std::cout << "  Events received: " << stats.received
+              << ", dispatched: " << stats.dispatched << std::endl;
+    std::cout << "  Collapsed: " << collapsed
+              << " (motion " << stats.motion_collapsed
+              << ", configure " << stats.configure_collapsed
+              << ", property " << stats.property_collapsed << ")" << std::endl;
+
+    if (root_properties_) {
+        const RootPropertyPublisher::Stats& props = root_properties_->get_stats();
+        unsigned long saved = props.staged - props.replaced - props.appended - props.deleted;
+        std::cout << "Root property writes:" << std::endl;
+        std::cout << "  Staged: " << props.staged << ", written: "
+                  << props.replaced + props.appended + props.deleted
+                  << " (replace " << props.replaced << ", append " << props.appended
+                  << ", delete " << props.deleted << ")" << std::endl;
+        std::cout << "  Saved: " << saved << " (coalesced " << props.coalesced
+                  << ", unchanged " << props.skipped << ")" << std::endl;
+    }
+
+    if (compositor_) {
+        const Compositor::Stats& comp = compositor_->get_stats();
+        std::cout << "Compositor:" << std::endl;
+        std::cout << "  Frames: " << comp.frames << ", damage events: " << comp.damage_events;
+        if (comp.frames) {
+            std::cout << ", average paint " << comp.paint_time.count() / comp.frames << " us";
+        }
+        std::cout << std::endl;
+        std::cout << "  Windows painted: " << comp.windows_painted
+                  << ", skipped as occluded: " << comp.windows_occluded
+                  << ", pixels repainted: " << comp.pixels_painted << std::endl;
+        std::cout << "  Unredirected: " << comp.unredirects
+                  << ", redirected again: " << comp.redirects << ", now bypassing:";
+        for (::Window toplevel : compositor_->get_unredirected()) {
+            std::cout << " 0x" << std::hex << toplevel << std::dec;
+        }
+        std::cout << std::endl;
+    }
+
+    if (decorator_) {
+        const Decorator::Stats& decor = decorator_->get_stats();
+        const DecorationCache::Stats& cache = decorator_->get_cache_stats();
+        const TitleLayoutCache::Stats& layouts = decorator_->get_layout_stats();
+        std::cout << "Decorations:" << std::endl;
+        std::cout << "  Draws: " << decor.draws << ", title renders: " << decor.title_renders
+                  << ", title reuses: " << decor.title_reuses << std::endl;
+        std::cout << "  Frame shapes: " << decor.shape_sets << " set, "
+                  << decor.shape_updates << " edge updates" << std::endl;
+        std::cout << "  Part cache: " << cache.hits << " hits, " << cache.misses
+                  << " misses, " << cache.pixmaps << " pixmaps" << std::endl;
+        std::cout << "  Title layouts: " << layouts.hits << " hits, " << layouts.misses
+                  << " shaped, " << layouts.evictions << " evicted" << std::endl;
+    }
+
+    const SpatialIndex::Stats& spatial = spatial_.get_stats();
+    std::cout << "Spatial index: " << spatial.inserts << " inserts, " << spatial.updates
+              << " updates (" << spatial.relinks << " relinked), " << spatial.queries
+              << " queries over " << spatial.candidates << " candidates" << std::endl;
+
+    const Placement::Stats& placement = placement_.get_stats();
+    std::cout << "Smart placement: " << placement.placements << " windows ("
+              << placement.overlapping << " overlapping)";
+    if (placement.placements > 0) {
+        std::cout << ", " << placement.total_latency.count() / placement.placements
+                  << " us average, " << placement.max_latency.count() << " us max";
+    }
+    std::cout << std::endl;
+
+    const LayoutEngine::Stats& layout = layouts_.get_stats();
+    std::cout << "Layouts: " << layout.arranges << " arranges, " << layout.slots_computed
+              << " slots computed, " << layout.slots_reused << " reused; "
+              << layout.configures << " configures, " << layout.unchanged << " already in place"
+              << std::endl;
+
+    const WorkspaceStats& switches = workspace_stats_;
+    std::cout << "Workspace switches: " << switches.switches
+              << " (hidden " << switches.hidden << ", shown " << switches.shown << ")";
+    if (switches.measured) {
+        std::cout << ", average latency " << switches.total_latency.count() / switches.measured
+                  << " us, worst " << switches.max_latency.count() << " us";
+    }
+    std::cout << std::endl;
+
+    if (switcher_) {
+        const WindowSwitcher::Stats& switcher = switcher_->get_stats();
+        std::cout << "Window switcher: " << switcher.sessions << " sessions, "
+                  << switcher.steps << " steps, " << switcher.skipped << " skipped by policy ("
+                  << switcher.committed << " committed, " << switcher.cancelled << " cancelled)"
+                  << std::endl;
+    }
+
+    if (move_resize_) {
+        const MoveResize::Stats& moves = move_resize_->get_stats();
+        std::cout << "Interactive move/resize:" << std::endl;
+        std::cout << "  Grabs: " << moves.grabs << ", pointer updates: " << moves.motions
+                  << ", applied: " << moves.applied << std::endl;
+        std::cout << "  Sync requests: " << moves.sync_requests
+                  << " (deferred " << moves.sync_deferred
+                  << ", timed out " << moves.sync_timeouts << ")" << std::endl;
+    }
+
+    if (outputs_) {
+        const OutputModel::Stats& outputs = outputs_->get_stats();
+        std::cout << "Outputs: " << outputs_->get_outputs().size() << " (" << outputs.events
+                  << " RandR events, " << outputs.rebuilds << " rebuilds, " << outputs.changes
+                  << " changes, " << outputs.lookups << " lookups)" << std::endl;
+    }
+
+    const EdgeIndex::Stats& snapping = snap_edges_.get_stats();
+    std::cout << "Edge snapping: " << snapping.checks << " checks, " << snapping.probes
+              << " edges probed, " << snapping.snapped << " snapped; "
+              << snapping.updates << " edge updates" << std::endl;
+
+    if (frame_pool_) {
+        const FramePool::Stats& pool = frame_pool_->get_stats();
+        unsigned long taken = pool.hits + pool.misses;
+        std::cout << "Frame pool: " << pool.hits << " hits, " << pool.misses << " misses ("
+                  << (taken ? 100 * pool.hits / taken : 0) << "% hit rate), "
+                  << pool.recycled << " recycled, " << pool.destroyed << " destroyed, "
+                  << pool.refilled << " created while idle" << std::endl;
+        const char* sources[2] = { "new", "pooled" };
+        for (int pooled = 1; pooled >= 0; --pooled) {
+            if (pool.shown[pooled] > 0) {
+                std::cout << "  Map-to-visible latency, " << sources[pooled] << " frames: "
+                          << pool.total_visible_latency[pooled].count() / pool.shown[pooled]
+                          << " us average, " << pool.max_visible_latency[pooled].count()
+                          << " us max (" << pool.shown[pooled] << " windows)" << std::endl;
+            }
+        }
+    }
+
+    const WorkAreas::Stats& areas = work_areas_.get_stats();
+    std::cout << "Work areas: " << areas.computes << " computes, " << areas.changes
+              << " changes" << std::endl;
+
+    Logger::Stats log = Logger::instance().get_stats();
+    std::cout << "Log: " << log.written << " records, " << log.dropped
+              << " dropped" << std::endl;
+}
+
 void WindowManager::shutdown() {
     if (!display_) {
         return;
@@ -105,16 +502,27 @@ void WindowManager::shutdown() {
 
     running_ = false;
 
+    // Queued log records come out before the stats
+    Logger::instance().sync();
+    print_stats();
+
     // Unmanage all windows
-    auto windows_copy = windows_;
-    for (auto& [xwin, window] : windows_copy) {
+    std::vector<::Window> managed;
+    managed.reserve(windows_.size());
+    for (Window& window : windows_) {
+        managed.push_back(window.get_xwindow());
+    }
+    for (::Window xwin : managed) {
         unmanage_window(xwin);
     }
 
-    windows_.clear();
     workspaces_.clear();
-    focused_window_.reset();
+    focused_window_ = WindowHandle();
+    move_resize_.reset();
+    switcher_.reset();
+    compositor_.reset();
     decorator_.reset();
+    frame_pool_.reset();
 
     if (display_) {
         XCloseDisplay(display_);
@@ -162,114 +570,64 @@ bool WindowManager::become_window_manager() {
     return true;
 }
 
-void WindowManager::init_atoms() {
-    // WM protocols
-    atoms_.wm_protocols = XInternAtom(display_, "WM_PROTOCOLS", False);
-    atoms_.wm_delete_window = XInternAtom(display_, "WM_DELETE_WINDOW", False);
-    atoms_.wm_state = XInternAtom(display_, "WM_STATE", False);
-    atoms_.wm_change_state = XInternAtom(display_, "WM_CHANGE_STATE", False);
-    atoms_.wm_take_focus = XInternAtom(display_, "WM_TAKE_FOCUS", False);
-
-    // EWMH atoms
-    atoms_.net_supported = XInternAtom(display_, "_NET_SUPPORTED", False);
-    atoms_.net_client_list = XInternAtom(display_, "_NET_CLIENT_LIST", False);
-    atoms_.net_client_list_stacking = XInternAtom(display_, "_NET_CLIENT_LIST_STACKING", False);
-    atoms_.net_number_of_desktops = XInternAtom(display_, "_NET_NUMBER_OF_DESKTOPS", False);
-    atoms_.net_desktop_geometry = XInternAtom(display_, "_NET_DESKTOP_GEOMETRY", False);
-    atoms_.net_desktop_viewport = XInternAtom(display_, "_NET_DESKTOP_VIEWPORT", False);
-    atoms_.net_current_desktop = XInternAtom(display_, "_NET_CURRENT_DESKTOP", False);
-    atoms_.net_desktop_names = XInternAtom(display_, "_NET_DESKTOP_NAMES", False);
-    atoms_.net_active_window = XInternAtom(display_, "_NET_ACTIVE_WINDOW", False);
-    atoms_.net_workarea = XInternAtom(display_, "_NET_WORKAREA", False);
-    atoms_.net_supporting_wm_check = XInternAtom(display_, "_NET_SUPPORTING_WM_CHECK", False);
-    atoms_.net_wm_name = XInternAtom(display_, "_NET_WM_NAME", False);
-    atoms_.net_wm_state = XInternAtom(display_, "_NET_WM_STATE", False);
-    atoms_.net_wm_state_modal = XInternAtom(display_, "_NET_WM_STATE_MODAL", False);
-    atoms_.net_wm_state_sticky = XInternAtom(display_, "_NET_WM_STATE_STICKY", False);
-    atoms_.net_wm_state_maximized_vert = XInternAtom(display_, "_NET_WM_STATE_MAXIMIZED_VERT", False);
-    atoms_.net_wm_state_maximized_horz = XInternAtom(display_, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
-    atoms_.net_wm_state_shaded = XInternAtom(display_, "_NET_WM_STATE_SHADED", False);
-    atoms_.net_wm_state_skip_taskbar = XInternAtom(display_, "_NET_WM_STATE_SKIP_TASKBAR", False);
-    atoms_.net_wm_state_skip_pager = XInternAtom(display_, "_NET_WM_STATE_SKIP_PAGER", False);
-    atoms_.net_wm_state_hidden = XInternAtom(display_, "_NET_WM_STATE_HIDDEN", False);
-    atoms_.net_wm_state_fullscreen = XInternAtom(display_, "_NET_WM_STATE_FULLSCREEN", False);
-    atoms_.net_wm_state_above = XInternAtom(display_, "_NET_WM_STATE_ABOVE", False);
-    atoms_.net_wm_state_below = XInternAtom(display_, "_NET_WM_STATE_BELOW", False);
-    atoms_.net_wm_window_type = XInternAtom(display_, "_NET_WM_WINDOW_TYPE", False);
-    atoms_.net_wm_window_type_desktop = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_DESKTOP", False);
-    atoms_.net_wm_window_type_dock = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_DOCK", False);
-    atoms_.net_wm_window_type_toolbar = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_TOOLBAR", False);
-    atoms_.net_wm_window_type_menu = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_MENU", False);
-    atoms_.net_wm_window_type_utility = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_UTILITY", False);
-    atoms_.net_wm_window_type_splash = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_SPLASH", False);
-    atoms_.net_wm_window_type_dialog = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_DIALOG", False);
-    atoms_.net_wm_window_type_normal = XInternAtom(display_, "_NET_WM_WINDOW_TYPE_NORMAL", False);
-    atoms_.net_close_window = XInternAtom(display_, "_NET_CLOSE_WINDOW", False);
-    atoms_.net_moveresize_window = XInternAtom(display_, "_NET_MOVERESIZE_WINDOW", False);
-    atoms_.net_wm_moveresize = XInternAtom(display_, "_NET_WM_MOVERESIZE", False);
-}
-
 void WindowManager::setup_ewmh() {
     // Advertise EWMH support
     Atom supported[] = {
-        atoms_.net_supported,
-        atoms_.net_client_list,
-        atoms_.net_client_list_stacking,
-        atoms_.net_number_of_desktops,
-        atoms_.net_desktop_geometry,
-        atoms_.net_desktop_viewport,
-        atoms_.net_current_desktop,
-        atoms_.net_desktop_names,
-        atoms_.net_active_window,
-        atoms_.net_workarea,
-        atoms_.net_supporting_wm_check,
-        atoms_.net_wm_name,
-        atoms_.net_wm_state,
-        atoms_.net_wm_state_modal,
-        atoms_.net_wm_state_sticky,
-        atoms_.net_wm_state_maximized_vert,
-        atoms_.net_wm_state_maximized_horz,
-        atoms_.net_wm_state_shaded,
-        atoms_.net_wm_state_skip_taskbar,
-        atoms_.net_wm_state_skip_pager,
-        atoms_.net_wm_state_hidden,
-        atoms_.net_wm_state_fullscreen,
-        atoms_.net_wm_state_above,
-        atoms_.net_wm_state_below,
-        atoms_.net_wm_window_type,
-        atoms_.net_wm_window_type_desktop,
-        atoms_.net_wm_window_type_dock,
-        atoms_.net_wm_window_type_toolbar,
-        atoms_.net_wm_window_type_menu,
-        atoms_.net_wm_window_type_utility,
-        atoms_.net_wm_window_type_splash,
-        atoms_.net_wm_window_type_dialog,
-        atoms_.net_wm_window_type_normal,
-        atoms_.net_close_window,
-        atoms_.net_moveresize_window,
-        atoms_.net_wm_moveresize
+        atoms().net_supported,
+        atoms().net_client_list,
+        atoms().net_client_list_stacking,
+        atoms().net_number_of_desktops,
+        atoms().net_desktop_geometry,
+        atoms().net_desktop_viewport,
+        atoms().net_current_desktop,
+        atoms().net_desktop_names,
+        atoms().net_active_window,
+        atoms().net_workarea,
+        atoms().net_supporting_wm_check,
+        atoms().net_wm_name,
+        atoms().net_wm_visible_name,
+        atoms().net_wm_state,
+        atoms().net_wm_state_modal,
+        atoms().net_wm_state_sticky,
+        atoms().net_wm_state_maximized_vert,
+        atoms().net_wm_state_maximized_horz,
+        atoms().net_wm_state_shaded,
+        atoms().net_wm_state_skip_taskbar,
+        atoms().net_wm_state_skip_pager,
+        atoms().net_wm_state_hidden,
+        atoms().net_wm_state_fullscreen,
+        atoms().net_wm_state_above,
+        atoms().net_wm_state_below,
+        atoms().net_wm_window_type,
+        atoms().net_wm_window_type_desktop,
+        atoms().net_wm_window_type_dock,
+        atoms().net_wm_window_type_toolbar,
+        atoms().net_wm_window_type_menu,
+        atoms().net_wm_window_type_utility,
+        atoms().net_wm_window_type_splash,
+        atoms().net_wm_window_type_dialog,
+        atoms().net_wm_window_type_normal,
+        atoms().net_close_window,
+        atoms().net_moveresize_window,
+        atoms().net_wm_moveresize,
+        atoms().net_wm_sync_request,
+        atoms().net_wm_sync_request_counter,
+        atoms().net_wm_strut,
+        atoms().net_wm_strut_partial
     };
 
-    XChangeProperty(display_, root_, atoms_.net_supported,
+    XChangeProperty(display_, root_, atoms().net_supported,
         XA_ATOM, 32, PropModeReplace,
         (unsigned char*)supported, sizeof(supported) / sizeof(Atom));
 
-    // Set number of desktops
-    unsigned long num_desktops = num_workspaces_;
-    XChangeProperty(display_, root_, atoms_.net_number_of_desktops,
-        XA_CARDINAL, 32, PropModeReplace,
-        (unsigned char*)&num_desktops, 1);
-
-    // Set current desktop
-    unsigned long current = current_workspace_;
-    XChangeProperty(display_, root_, atoms_.net_current_desktop,
-        XA_CARDINAL, 32, PropModeReplace,
-        (unsigned char*)&current, 1);
+    // Set number of desktops and current desktop
+    root_properties_->set_value(atoms().net_number_of_desktops, XA_CARDINAL, num_workspaces_);
+    root_properties_->set_value(atoms().net_current_desktop, XA_CARDINAL, current_workspace_);
 
     // Set WM name
     const char* wm_name = "Malgoro";
-    XChangeProperty(display_, root_, atoms_.net_wm_name,
-        XInternAtom(display_, "UTF8_STRING", False), 8, PropModeReplace,
+    XChangeProperty(display_, root_, atoms().net_wm_name,
+        atoms().utf8_string, 8, PropModeReplace,
         (unsigned char*)wm_name, strlen(wm_name));
 }
 
@@ -346,52 +704,124 @@ void WindowManager::grab_buttons() {
 }
 
 void WindowManager::scan_existing_windows() {
-    XGrabServer(display_);
+    auto start = std::chrono::steady_clock::now();
 
     ::Window returned_root, returned_parent;
-    ::Window* top_level_windows;
-    unsigned int num_top_level_windows;
+    ::Window* top_level_windows = nullptr;
+    unsigned int num_top_level_windows = 0;
 
-    XQueryTree(display_, root_,
-        &returned_root, &returned_parent,
-        &top_level_windows, &num_top_level_windows);
+    if (!XQueryTree(display_, root_,
+            &returned_root, &returned_parent,
+            &top_level_windows, &num_top_level_windows)) {
+        return;
+    }
 
+    // Phase 1: pipeline attribute queries for every child, then collect.
+    // No server grab is held while waiting on replies.
+    std::vector<PropertyFetch> fetches;
+    fetches.reserve(num_top_level_windows);
     for (unsigned int i = 0; i < num_top_level_windows; ++i) {
-        XWindowAttributes attrs;
-        if (XGetWindowAttributes(display_, top_level_windows[i], &attrs)) {
-            // Only manage visible windows that are not override-redirect
-            if (!attrs.override_redirect && attrs.map_state == IsViewable) {
-                manage_window(top_level_windows[i]);
-            }
+        fetches.emplace_back(display_, top_level_windows[i], WindowProperties::ATTRIBUTES);
+    }
+    XFree(top_level_windows);
+
+    // Only manage visible windows that are not override-redirect; their
+    // remaining properties are fetched in a second pipelined burst
+    std::vector<PropertyFetch> candidates;
+    std::vector<WindowProperties> candidate_props;
+    for (auto& fetch : fetches) {
+        WindowProperties props;
+        if (fetch.collect(props) && !props.override_redirect && props.viewable) {
+            candidates.emplace_back(display_, fetch.get_window(),
+                WindowProperties::ALL & ~WindowProperties::ATTRIBUTES);
+            candidate_props.push_back(props);
         }
     }
+    fetches.clear();
 
-    XFree(top_level_windows);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        candidates[i].collect(candidate_props[i]);
+    }
+
+    // Phase 2: frame and reparent everything in one batch. The grab only
+    // covers request generation, which needs no round trips.
+    adopted_windows_.clear();
+    XGrabServer(display_);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (adopt_window(candidates[i].get_window(), candidate_props[i])) {
+            adopted_windows_.push_back(windows_.find(candidates[i].get_window())->get_handle());
+        }
+    }
+    update_client_list();
+    commit_stacking();
+    root_properties_->flush();
     XUngrabServer(display_);
+
+    // Every event the adoption caused (reparent unmaps and maps) is queued
+    // once this returns; check_adopted_windows() runs after they are handled
+    XSync(display_, False);
+    adoption_events_ = XEventsQueued(display_, QueuedAlready);
+
+    size_t adopted = adopted_windows_.size();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double per_second = elapsed.count() > 0.0 ? adopted * 1000.0 / elapsed.count() : 0.0;
+    std::cout << "Adopted " << adopted << " existing windows in "
+              << elapsed.count() << " ms (" << per_second << " windows/s)" << std::endl;
+}
+
+void WindowManager::check_adopted_windows() {
+    // Adoption is only done once the windows survive their own reparenting
+    size_t kept = std::count_if(adopted_windows_.begin(), adopted_windows_.end(),
+        [&](WindowHandle handle) { return windows_.get(handle) != nullptr; });
+    if (kept < adopted_windows_.size()) {
+        LOG_WARNING("Only {} of {} adopted windows are still managed",
+            kept, adopted_windows_.size());
+    } else {
+        LOG_INFO("All {} adopted windows are still managed", kept);
+    }
+    adopted_windows_.clear();
 }
 
 bool WindowManager::manage_window(::Window xwindow) {
     // Check if already managed
-    if (windows_.find(xwindow) != windows_.end()) {
+    if (windows_.find(xwindow)) {
         return false;
     }
 
-    // Get window attributes
-    XWindowAttributes attrs;
-    if (!XGetWindowAttributes(display_, xwindow, &attrs)) {
+    // Fetch attributes and all properties in one pipelined burst
+    WindowProperties props;
+    PropertyFetch fetch(display_, xwindow, WindowProperties::ALL);
+    if (!fetch.collect(props)) {
         return false;
     }
 
     // Don't manage override-redirect windows
-    if (attrs.override_redirect) {
+    if (props.override_redirect) {
+        return false;
+    }
+
+    if (!adopt_window(xwindow, props)) {
+        return false;
+    }
+
+    // Update client list
+    update_client_list();
+
+    return true;
+}
+
+bool WindowManager::adopt_window(::Window xwindow, const WindowProperties& props) {
+    if (windows_.find(xwindow)) {
         return false;
     }
 
-    std::cout << "Managing window: " << xwindow << std::endl;
+    LOG_INFO("Managing window: {}", xwindow);
 
-    // Create Window object
-    auto window = std::make_shared<Window>(xwindow, display_);
-    windows_[xwindow] = window;
+    // Create Window record
+    WindowHandle handle = windows_.insert(xwindow, display_, props);
+    Window* window = windows_.get(handle);
+    client_list_.push_back(xwindow);
 
     // Select events we want from this window
     XSelectInput(display_, xwindow,
@@ -400,50 +830,100 @@ bool WindowManager::manage_window(::Window xwindow) {
 
     // Add to current workspace
     if (current_workspace_ < workspaces_.size()) {
-        workspaces_[current_workspace_]->add_window(window);
+        workspaces_[current_workspace_]->add_window(windows_, *window);
     }
-
-    // Create frame/decoration
+    update_strut(*window);
+
+    // Create frame/decoration; events on the frame resolve to this window
+    window->create_frame(*frame_pool_);
+    windows_.index_frame(handle, window->get_frame());
+
+    // Windows mapped before we started keep their place, as do windows
+    // that ask for a position; many clients send PPosition at the origin
+    // without meaning it
+    bool positioned = (props.size_flags & USPosition) ||
+        ((props.size_flags & PPosition) && (window->get_x() != 0 || window->get_y() != 0));
+    if (!props.viewable && !positioned) {
+        place_window(window);
+    }
+    spatial_.insert(*window, window->get_workspace(), get_frame_rect(*window));
+    snap_edges_.insert(*window, window->get_workspace(), get_frame_rect(*window));
+    stacking_.add(windows_, *window);
+    update_visible_name(window);
     if (decorator_) {
         decorator_->decorate_window(window);
     }
 
-    // Map the window
-    XMapWindow(display_, xwindow);
+    // Fit into the workspace's layout, if it has one
+    layouts_.window_added(windows_, window->get_workspace(), *window);
 
-    // Update client list
-    update_client_list();
+    // Games and players often ask for fullscreen before mapping
+    if (std::find(props.state.begin(), props.state.end(), atoms().net_wm_state_fullscreen) !=
+        props.state.end()) {
+        fullscreen_window(window);
+    }
+
+    // Map the window
+    window->map();
 
     return true;
 }
 
 bool WindowManager::unmanage_window(::Window xwindow) {
-    auto it = windows_.find(xwindow);
-    if (it == windows_.end()) {
+    // Only the client ID unmanages; frame events resolve to the same record
+    Window* window = windows_.find(xwindow);
+    if (!window || window->get_xwindow() != xwindow) {
         return false;
     }
 
-    std::cout << "Unmanaging window: " << xwindow << std::endl;
+    LOG_INFO("Unmanaging window: {}", xwindow);
 
-    auto window = it->second;
+    // Drop an interactive move/resize of this window
+    if (move_resize_->get_window() == window->get_handle()) {
+        move_resize_->end(windows_, true);
+    }
+
+    // A switch to this window can no longer be committed
+    if (switcher_->get_selection() == window->get_handle()) {
+        switcher_->end(true);
+        preview_switch(WindowHandle());
+    }
 
     // Remove from focused window if needed
-    if (focused_window_ == window) {
-        focused_window_.reset();
+    if (focused_window_ == window->get_handle()) {
+        focused_window_ = WindowHandle();
+        update_active_window();
     }
 
-    // Remove from all workspaces
-    for (auto& workspace : workspaces_) {
-        workspace->remove_window(window);
+    auto listed = std::find(client_list_.begin(), client_list_.end(), xwindow);
+    if (listed != client_list_.end()) {
+        client_list_.erase(listed);
     }
 
+    // Remove from its workspace and close the gap in its layout
+    layouts_.window_removed(windows_, window->get_workspace(), *window);
+    spatial_.remove(*window);
+    snap_edges_.remove(*window);
+    work_areas_.remove(window->get_handle());
+    if (Workspace* workspace = get_workspace_of(*window)) {
+        workspace->remove_window(windows_, *window);
+    }
+
+    // Its " <N>" suffix becomes free for the next window with its title
+    release_title_number(*window);
+
+    // A pending workspace switch no longer waits for its frame
+    note_switch_mapped(window->get_frame());
+
     // Remove decoration
     if (decorator_) {
         decorator_->undecorate_window(window);
     }
 
-    // Remove from map
-    windows_.erase(it);
+    stacking_.remove(windows_, *window);
+
+    // Release the slot; outstanding handles to it become stale
+    windows_.erase(window->get_handle());
 
     // Update client list
     update_client_list();
@@ -451,39 +931,34 @@ bool WindowManager::unmanage_window(::Window xwindow) {
     return true;
 }
 
-std::shared_ptr<Window> WindowManager::find_window(::Window xwindow) {
-    auto it = windows_.find(xwindow);
-    if (it != windows_.end()) {
-        return it->second;
-    }
-    return nullptr;
-}
-
-std::vector<std::shared_ptr<Window>> WindowManager::get_all_windows() {
-    std::vector<std::shared_ptr<Window>> result;
-    result.reserve(windows_.size());
-    for (auto& [xwin, window] : windows_) {
-        result.push_back(window);
-    }
-    return result;
+Window* WindowManager::find_window(::Window xwindow) {
+    return windows_.find(xwindow);
 }
 
-void WindowManager::focus_window(std::shared_ptr<Window> window) {
+void WindowManager::focus_window(Window* window) {
     if (!window) {
         return;
     }
 
     // Unfocus previous window
-    if (focused_window_ && focused_window_ != window) {
+    Window* previous = get_focused_window();
+    if (previous && previous != window) {
+        previous->set_focused(false);
+        stacking_.update_layer(windows_, *previous);
         if (decorator_) {
-            decorator_->set_window_active(focused_window_, false);
+            decorator_->set_window_active(previous, false);
         }
     }
 
-    // Focus new window
-    focused_window_ = window;
+    // Focus new window; the frame is raised when stacking is committed
+    focused_window_ = window->get_handle();
+    if (Workspace* workspace = get_workspace_of(*window)) {
+        workspace->touch(windows_, *window);
+    }
+    window->set_focused(true);
     XSetInputFocus(display_, window->get_xwindow(), RevertToPointerRoot, CurrentTime);
-    XRaiseWindow(display_, window->get_xwindow());
+    stacking_.update_layer(windows_, *window);
+    stacking_.raise(windows_, *window);
 
     // Update decoration
     if (decorator_) {
@@ -494,44 +969,30 @@ void WindowManager::focus_window(std::shared_ptr<Window> window) {
     update_active_window();
 }
 
-std::shared_ptr<Window> WindowManager::get_focused_window() {
-    return focused_window_;
+Window* WindowManager::get_focused_window() {
+    return windows_.get(focused_window_);
 }
 
 void WindowManager::cycle_focus(bool reverse) {
-    if (windows_.empty()) {
-        return;
-    }
-
-    auto windows = get_all_windows();
-    if (windows.empty()) {
-        return;
-    }
+    // Immediate switch to the next window in MRU order, without a session
+    WindowHandle next = switcher_->find_next(windows_, *workspaces_[current_workspace_],
+        focused_window_, reverse);
+    focus_window(windows_.get(next));
+}
 
-    // Find current focused window index
-    int current_index = -1;
-    for (size_t i = 0; i < windows.size(); ++i) {
-        if (windows[i] == focused_window_) {
-            current_index = i;
-            break;
-        }
+void WindowManager::raise_window(Window* window) {
+    if (window) {
+        stacking_.raise(windows_, *window);
     }
+}
 
-    // Calculate next index
-    int next_index;
-    if (current_index == -1) {
-        next_index = 0;
-    } else if (reverse) {
-        next_index = (current_index - 1 + windows.size()) % windows.size();
-    } else {
-        next_index = (current_index + 1) % windows.size();
+void WindowManager::lower_window(Window* window) {
+    if (window) {
+        stacking_.lower(windows_, *window);
     }
-
-    // Focus next window
-    focus_window(windows[next_index]);
 }
 
-void WindowManager::close_window(std::shared_ptr<Window> window) {
+void WindowManager::close_window(Window* window) {
     if (!window) {
         return;
     }
@@ -541,59 +1002,69 @@ void WindowManager::close_window(std::shared_ptr<Window> window) {
     memset(&event, 0, sizeof(event));
     event.type = ClientMessage;
     event.xclient.window = window->get_xwindow();
-    event.xclient.message_type = atoms_.wm_protocols;
+    event.xclient.message_type = atoms().wm_protocols;
     event.xclient.format = 32;
-    event.xclient.data.l[0] = atoms_.wm_delete_window;
+    event.xclient.data.l[0] = atoms().wm_delete_window;
     event.xclient.data.l[1] = CurrentTime;
 
     XSendEvent(display_, window->get_xwindow(), False, NoEventMask, &event);
     XFlush(display_);
 }
 
-void WindowManager::maximize_window(std::shared_ptr<Window> window) {
-    if (!window) {
+void WindowManager::maximize_window(Window* window) {
+    if (!window || window->is_maximized()) {
         return;
     }
 
-    // TODO: Implement maximize
-    std::cout << "Maximize window: " << window->get_xwindow() << std::endl;
+    // Maximized windows leave their workspace's layout until restored
+    layouts_.window_removed(windows_, window->get_workspace(), *window);
+    window->set_maximized(true, get_work_area_of(*window));
+    publish_state(window);
 }
 
 void WindowManager::update_client_list() {
-    std::vector<::Window> client_list;
-    client_list.reserve(windows_.size());
+    // client_list_ is kept in mapping order, so managing a window only
+    // appends to the published property
+    root_properties_->set_list(atoms().net_client_list, XA_WINDOW, client_list_, true);
+}
 
-    for (auto& [xwin, window] : windows_) {
-        client_list.push_back(xwin);
+void WindowManager::commit_stacking() {
+    if (!stacking_.is_dirty()) {
+        return;
     }
 
-    if (!client_list.empty()) {
-        XChangeProperty(display_, root_, atoms_.net_client_list,
-            XA_WINDOW, 32, PropModeReplace,
-            (unsigned char*)client_list.data(), client_list.size());
-    } else {
-        XDeleteProperty(display_, root_, atoms_.net_client_list);
+    if (stacking_.commit(display_, windows_, stacking_clients_)) {
+        root_properties_->set_list(atoms().net_client_list_stacking, XA_WINDOW, stacking_clients_);
     }
 }
 
 void WindowManager::update_active_window() {
-    if (focused_window_) {
-        ::Window xwin = focused_window_->get_xwindow();
-        XChangeProperty(display_, root_, atoms_.net_active_window,
-            XA_WINDOW, 32, PropModeReplace,
-            (unsigned char*)&xwin, 1);
-    } else {
-        XDeleteProperty(display_, root_, atoms_.net_active_window);
-    }
+    Window* focused = get_focused_window();
+    root_properties_->set_value(atoms().net_active_window, XA_WINDOW,
+        focused ? focused->get_xwindow() : None);
 }
 
 // Event handlers
 
 void WindowManager::handle_event(XEvent& event) {
+    // The compositor observes structure events and consumes damage
+    if (compositor_ && compositor_->handle_event(event)) {
+        return;
+    }
+    if (outputs_->handle_event(event)) {
+        return;
+    }
+
     switch (event.type) {
         case MapRequest:
             handle_map_request(event.xmaprequest);
             break;
+        case MapNotify:
+            if (event.xmap.event == root_) {
+                frame_pool_->note_mapped(event.xmap.window);
+                note_switch_mapped(event.xmap.window);
+            }
+            break;
         case UnmapNotify:
             handle_unmap_notify(event.xunmap);
             break;
@@ -621,9 +1092,15 @@ void WindowManager::handle_event(XEvent& event) {
         case MotionNotify:
             handle_motion_notify(event.xmotion);
             break;
+        case Expose:
+            handle_expose(event.xexpose);
+            break;
         case KeyPress:
             handle_key_press(event.xkey);
             break;
+        case KeyRelease:
+            handle_key_release(event.xkey);
+            break;
         case EnterNotify:
             handle_enter_notify(event.xcrossing);
             break;
@@ -636,6 +1113,10 @@ void WindowManager::handle_event(XEvent& event) {
         case FocusOut:
             handle_focus_out(event.xfocus);
             break;
+        default:
+            // Extension events
+            move_resize_->handle_sync_event(event);
+            break;
     }
 }
 
@@ -644,6 +1125,23 @@ void WindowManager::handle_map_request(XMapRequestEvent& event) {
 }
 
 void WindowManager::handle_unmap_notify(XUnmapEvent& event) {
+    // Frame unmaps are always our own (workspace switches)
+    Window* window = find_window(event.window);
+    if (!window || window->get_xwindow() != event.window) {
+        return;
+    }
+
+    // A client unmap is reported both to the client and to its frame;
+    // count it once. Synthetic unmaps (ICCCM withdrawal) come via the root.
+    if (!event.send_event && event.event != event.window) {
+        return;
+    }
+
+    // Unmaps the WM issued itself (minimize) do not withdraw the window
+    if (!event.send_event && window->consume_unmap()) {
+        return;
+    }
+
     unmanage_window(event.window);
 }
 
@@ -652,6 +1150,18 @@ void WindowManager::handle_destroy_notify(XDestroyWindowEvent& event) {
 }
 
 void WindowManager::handle_configure_request(XConfigureRequestEvent& event) {
+    // Stacking requests from managed clients go through the stacking model;
+    // the client window itself is a child of its frame
+    Window* window = find_window(event.window);
+    if (window && (event.value_mask & CWStackMode)) {
+        if (event.detail == Above || event.detail == TopIf) {
+            stacking_.raise(windows_, *window);
+        } else if (event.detail == Below || event.detail == BottomIf) {
+            stacking_.lower(windows_, *window);
+        }
+        event.value_mask &= ~(CWStackMode | CWSibling);
+    }
+
     XWindowChanges changes;
     changes.x = event.x;
     changes.y = event.y;
@@ -665,11 +1175,145 @@ void WindowManager::handle_configure_request(XConfigureRequestEvent& event) {
 }
 
 void WindowManager::handle_configure_notify(XConfigureEvent& event) {
-    // Handle configuration changes
+    // Frames are children of the root; index them where the server put them
+    if (event.event != root_) {
+        return;
+    }
+    Window* window = find_window(event.window);
+    if (!window || window->get_frame() != event.window) {
+        return;
+    }
+    Layout::Rect frame{ event.x, event.y,
+        event.width + 2 * event.border_width, event.height + 2 * event.border_width };
+    spatial_.update(*window, frame);
+    snap_edges_.update(*window, frame);
 }
 
 void WindowManager::handle_property_notify(XPropertyEvent& event) {
-    // Handle property changes
+    unsigned int field = property_field(event.atom);
+    if (!field) {
+        return;
+    }
+
+    Window* window = find_window(event.window);
+    if (!window || window->get_xwindow() != event.window) {
+        return;
+    }
+
+    // Defer the fetch to the end of the batch; repeated notifies for the
+    // same field only set the bit again
+    if (!window->get_dirty_properties()) {
+        dirty_windows_.push_back(window->get_handle());
+    }
+    window->mark_properties_dirty(field);
+}
+
+void WindowManager::refresh_dirty_properties() {
+    if (dirty_windows_.empty()) {
+        return;
+    }
+
+    // Issue every window's requests before collecting any reply, so the
+    // whole batch costs one round trip
+    property_fetches_.clear();
+    for (WindowHandle handle : dirty_windows_) {
+        if (Window* window = windows_.get(handle)) {
+            property_fetches_.emplace_back(display_, window->get_xwindow(),
+                window->get_dirty_properties());
+            window->clear_dirty_properties();
+        }
+    }
+
+    for (size_t i = 0; i < property_fetches_.size(); ++i) {
+        WindowProperties props;
+        if (!property_fetches_[i].collect(props)) {
+            continue;
+        }
+
+        // Look the window up again; handles of unmanaged windows are stale
+        Window* window = windows_.find(property_fetches_[i].get_window());
+        if (!window) {
+            continue;
+        }
+
+        unsigned int changed = window->apply_properties(props);
+        if (changed) {
+            on_properties_changed(window, changed);
+        }
+    }
+
+    property_fetches_.clear();
+    dirty_windows_.clear();
+}
+
+void WindowManager::on_properties_changed(Window* window, unsigned int changed) {
+    if (changed & WindowProperties::TITLE) {
+        update_visible_name(window);
+        if (decorator_) {
+            decorator_->draw(window, window->is_focused());
+        }
+    }
+
+    if (changed & (WindowProperties::STATE | WindowProperties::TYPE)) {
+        stacking_.update_layer(windows_, *window);
+    }
+
+    // Stickiness decides which workspaces a strut applies to
+    if (changed & (WindowProperties::STRUT | WindowProperties::STATE)) {
+        update_strut(*window);
+    }
+}
+
+void WindowManager::update_visible_name(Window* window) {
+    // Windows sharing a title are told apart by the lowest free " <N>"
+    // suffix; a window shown under its own title gets no property. A
+    // window keeps its number until its title changes.
+    const std::string& title = window->get_title();
+    if (window->get_title_number() == 0 || window->get_numbered_title() != title) {
+        release_title_number(*window);
+        size_t number = 1;
+        if (!title.empty()) {
+            std::vector<bool>& used = title_numbers_[title];
+            while (number < used.size() && used[number]) {
+                number++;
+            }
+            if (number >= used.size()) {
+                used.resize(number + 1, false);
+            }
+            used[number] = true;
+        }
+        window->set_title_number(title, number);
+    }
+    size_t number = window->get_title_number();
+
+    std::string visible = number > 1 ? title + " <" + std::to_string(number) + ">" : std::string();
+    if (visible == window->get_visible_name()) {
+        return;
+    }
+    window->set_visible_name(visible);
+    if (visible.empty()) {
+        XDeleteProperty(display_, window->get_xwindow(), atoms().net_wm_visible_name);
+    } else {
+        XChangeProperty(display_, window->get_xwindow(), atoms().net_wm_visible_name,
+            atoms().utf8_string, 8, PropModeReplace,
+            (const unsigned char*)visible.data(), visible.size());
+    }
+}
+
+void WindowManager::release_title_number(Window& window) {
+    auto it = title_numbers_.find(window.get_numbered_title());
+    if (window.get_title_number() != 0 && it != title_numbers_.end()) {
+        // Index 1 is the plain title; drop titles no window has any more
+        std::vector<bool>& used = it->second;
+        used[window.get_title_number()] = false;
+        while (used.size() > 1 && !used.back()) {
+            used.pop_back();
+        }
+        if (used.size() <= 1) {
+            title_numbers_.erase(it);
+        }
+    }
+    window.set_title_number(std::string(), 0);
 }
 
 void WindowManager::handle_client_message(XClientMessageEvent& event) {
@@ -677,47 +1321,168 @@ void WindowManager::handle_client_message(XClientMessageEvent& event) {
 }
 
 void WindowManager::handle_button_press(XButtonEvent& event) {
-    auto window = find_window(event.window);
-    if (window) {
-        focus_window(window);
+    if (move_resize_->is_active()) {
+        return;
+    }
+
+    // Alt+button presses arrive through the passive grab on the root
+    bool alt_drag = event.window == root_ && (event.state & Mod1Mask);
+    Window* window = find_window(alt_drag ? event.subwindow : event.window);
+    if (!window) {
+        return;
+    }
+
+    focus_window(window);
+
+    if (alt_drag) {
+        if (event.button == Button1) {
+            move_resize_->begin(*window, MoveResize::Mode::MOVE, 0,
+                event.x_root, event.y_root, event.time);
+        } else if (event.button == Button3) {
+            // Resize from the corner nearest the pointer
+            int x, y, width, height;
+            window->get_frame_geometry(x, y, width, height);
+            int edges = (event.x_root < x + width / 2 ? MoveResize::EDGE_LEFT : MoveResize::EDGE_RIGHT) |
+                (event.y_root < y + height / 2 ? MoveResize::EDGE_TOP : MoveResize::EDGE_BOTTOM);
+            move_resize_->begin(*window, MoveResize::Mode::RESIZE, edges,
+                event.x_root, event.y_root, event.time);
+        }
+        return;
+    }
+
+    // Presses on the frame's titlebar or borders
+    if (event.window == window->get_frame() && event.button == Button1 && decorator_) {
+        if (decorator_->get_button_at(window, event.x, event.y) == Decorator::Button::MAXIMIZE) {
+            toggle_maximize(window);
+            return;
+        }
+        if (decorator_->handle_button_press(window, event.x, event.y, event.button)) {
+            return;
+        }
+
+        int border_mask = Decorator::BORDER_NONE;
+        if (decorator_->is_on_border(window, event.x, event.y, border_mask) && border_mask) {
+            move_resize_->begin(*window, MoveResize::Mode::RESIZE, border_mask,
+                event.x_root, event.y_root, event.time);
+        } else if (decorator_->is_in_titlebar(window, event.x, event.y)) {
+            move_resize_->begin(*window, MoveResize::Mode::MOVE, 0,
+                event.x_root, event.y_root, event.time);
+        }
+    }
+}
+
+void WindowManager::handle_expose(XExposeEvent& event) {
+    // Decorations are redrawn whole from cached pixmaps, so only the last
+    // expose of a series matters
+    if (event.count != 0) {
+        return;
+    }
+
+    Window* window = find_window(event.window);
+    if (window && event.window == window->get_frame()) {
+        if (decorator_) {
+            decorator_->draw(window, window->is_focused());
+        }
+        frame_pool_->note_painted(event.window);
     }
 }
 
 void WindowManager::handle_button_release(XButtonEvent& event) {
-    // Handle button release
+    if (move_resize_->is_active()) {
+        move_resize_->motion(event.x_root, event.y_root, event.time);
+        move_resize_->end(windows_);
+    }
 }
 
 void WindowManager::handle_motion_notify(XMotionEvent& event) {
-    // Handle mouse motion
+    if (move_resize_->is_active()) {
+        // Applied once at the end of the batch
+        move_resize_->motion(event.x_root, event.y_root, event.time);
+        return;
+    }
+
+    // Button hover over a frame
+    Window* window = find_window(event.window);
+    if (window && decorator_ && event.window == window->get_frame()) {
+        decorator_->handle_motion(window, event.x, event.y);
+    }
 }
 
 void WindowManager::handle_key_press(XKeyEvent& event) {
     KeySym keysym = XLookupKeysym(&event, 0);
     unsigned int modifiers = event.state & (ShiftMask | ControlMask | Mod1Mask | Mod4Mask);
 
-    // Alt+Tab - Switch windows
+    // Alt+Tab - Switch windows; focus changes when Alt is released
     if (keysym == XK_Tab && (modifiers & Mod1Mask)) {
         bool reverse = (modifiers & ShiftMask);
-        cycle_focus(reverse);
+        WindowHandle highlighted = switcher_->is_active() ? switcher_->get_selection() : focused_window_;
+        if (switcher_->is_active()) {
+            switcher_->step(windows_, *workspaces_[current_workspace_], reverse);
+        } else if (switcher_->begin(windows_, *workspaces_[current_workspace_], focused_window_,
+                reverse, event.time) && !switcher_->is_alt_held()) {
+            focus_window(windows_.get(switcher_->end()));
+            return;
+        }
+        preview_switch(highlighted);
+    }
+    // Escape - Cancel window switching
+    else if (keysym == XK_Escape && switcher_->is_active()) {
+        WindowHandle highlighted = switcher_->get_selection();
+        switcher_->end(true);
+        preview_switch(highlighted);
     }
     // Alt+F4 - Close window
     else if (keysym == XK_F4 && (modifiers & Mod1Mask)) {
-        if (focused_window_) {
-            close_window(focused_window_);
+        if (Window* focused = get_focused_window()) {
+            close_window(focused);
         }
     }
     // Alt+F10 - Maximize
     else if (keysym == XK_F10 && (modifiers & Mod1Mask)) {
-        if (focused_window_) {
-            toggle_maximize(focused_window_);
+        if (Window* focused = get_focused_window()) {
+            toggle_maximize(focused);
         }
     }
+    // Ctrl+Alt+Left/Right - Previous/next workspace
+    else if ((keysym == XK_Left || keysym == XK_Right) &&
+             (modifiers & (ControlMask | Mod1Mask)) == (ControlMask | Mod1Mask)) {
+        int count = static_cast<int>(workspaces_.size());
+        int step = keysym == XK_Left ? -1 : 1;
+        switch_workspace((current_workspace_ + step + count) % count);
+    }
+}
+
+void WindowManager::handle_key_release(XKeyEvent& event) {
+    if (!switcher_->is_active()) {
+        return;
+    }
+
+    // Releasing Alt commits the switch
+    KeySym keysym = XLookupKeysym(&event, 0);
+    if (keysym == XK_Alt_L || keysym == XK_Alt_R || keysym == XK_Meta_L || keysym == XK_Meta_R) {
+        focus_window(windows_.get(switcher_->end()));
+    }
+}
+
+void WindowManager::preview_switch(WindowHandle previous) {
+    // Only the decorations show the selection; focus and stacking wait
+    // for the switch to be committed
+    WindowHandle shown = switcher_->is_active() ? switcher_->get_selection() : focused_window_;
+    if (previous == shown || !decorator_) {
+        return;
+    }
+    if (Window* window = windows_.get(previous)) {
+        decorator_->set_window_active(window, false);
+    }
+    if (Window* window = windows_.get(shown)) {
+        decorator_->set_window_active(window, true);
+    }
 }
 
 void WindowManager::handle_enter_notify(XCrossingEvent& event) {
     if (focus_mode_ == FocusMode::FOCUS_FOLLOWS_MOUSE ||
         focus_mode_ == FocusMode::SLOPPY_FOCUS) {
-        auto window = find_window(event.window);
+        Window* window = find_window(event.window);
         if (window) {
             focus_window(window);
         }
@@ -725,7 +1490,10 @@ void WindowManager::handle_enter_notify(XCrossingEvent& event) {
 }
 
 void WindowManager::handle_leave_notify(XCrossingEvent& event) {
-    // Handle leave notify
+    Window* window = find_window(event.window);
+    if (window && decorator_ && event.window == window->get_frame()) {
+        decorator_->handle_leave(window);
+    }
 }
 
 void WindowManager::handle_focus_in(XFocusChangeEvent& event) {
@@ -738,18 +1506,54 @@ void WindowManager::handle_focus_out(XFocusChangeEvent& event) {
 
 void WindowManager::handle_ewmh_message(XClientMessageEvent& event) {
     // Handle EWMH client messages
-    if (event.message_type == atoms_.net_active_window) {
-        auto window = find_window(event.window);
+    if (event.message_type == atoms().net_active_window) {
+        Window* window = find_window(event.window);
         if (window) {
             focus_window(window);
         }
     }
-    else if (event.message_type == atoms_.net_close_window) {
-        auto window = find_window(event.window);
+    else if (event.message_type == atoms().net_close_window) {
+        Window* window = find_window(event.window);
         if (window) {
             close_window(window);
         }
     }
+    else if (event.message_type == atoms().net_current_desktop) {
+        switch_workspace(event.data.l[0]);
+    }
+    else if (event.message_type == atoms().net_wm_state) {
+        Window* window = find_window(event.window);
+        if (!window) {
+            return;
+        }
+
+        // data.l[0]: 0 remove, 1 add, 2 toggle; l[1] and l[2] name the states
+        Atom fullscreen = atoms().net_wm_state_fullscreen;
+        if (static_cast<Atom>(event.data.l[1]) == fullscreen ||
+            static_cast<Atom>(event.data.l[2]) == fullscreen) {
+            long action = event.data.l[0];
+            bool wanted = action == 2 ? !window->is_fullscreen() : action == 1;
+            if (wanted != window->is_fullscreen()) {
+                fullscreen_window(window);
+            }
+        }
+    }
+    else if (event.message_type == atoms().net_wm_moveresize) {
+        Window* window = find_window(event.window);
+        if (!window) {
+            return;
+        }
+
+        MoveResize::Mode mode;
+        int edges;
+        if (MoveResize::direction_to_edges(event.data.l[2], mode, edges)) {
+            move_resize_->begin(*window, mode, edges,
+                event.data.l[0], event.data.l[1], CurrentTime);
+        } else if (move_resize_->get_window() == window->get_handle()) {
+            // _NET_WM_MOVERESIZE_CANCEL
+            move_resize_->end(windows_, true);
+        }
+    }
 }
 
 // Static error handlers
@@ -757,10 +1561,9 @@ void WindowManager::handle_ewmh_message(XClientMessageEvent& event) {
 int WindowManager::on_x_error(Display* display, XErrorEvent* event) {
     char error_text[1024];
     XGetErrorText(display, event->error_code, error_text, sizeof(error_text));
-    std::cerr << "X11 Error: " << error_text << std::endl;
-    std::cerr << "  Request code: " << (int)event->request_code << std::endl;
-    std::cerr << "  Minor code: " << (int)event->minor_code << std::endl;
-    std::cerr << "  Resource ID: " << event->resourceid << std::endl;
+    // Races with destroyed clients make these routine; never stall on them
+    LOG_ERROR("X11 Error: {} (request code {}, minor code {}, resource {})",
+        error_text, event->request_code, event->minor_code, event->resourceid);
     return 0;
 }
 
@@ -771,12 +1574,140 @@ int WindowManager::on_wm_detected(Display* display, XErrorEvent* event) {
 
 // Stubs for remaining functions
 
-void WindowManager::toggle_maximize(std::shared_ptr<Window> window) {
-    // TODO: Implement
+void WindowManager::toggle_maximize(Window* window) {
+    if (!window) {
+        return;
+    }
+    if (window->is_maximized()) {
+        unmaximize_window(window);
+    } else {
+        maximize_window(window);
+    }
 }
 
 void WindowManager::switch_workspace(int workspace_index) {
-    // TODO: Implement
+    if (workspace_index < 0 || workspace_index >= static_cast<int>(workspaces_.size()) ||
+        workspace_index == current_workspace_) {
+        return;
+    }
+
+    if (switcher_->is_active()) {
+        WindowHandle highlighted = switcher_->get_selection();
+        switcher_->end(true);
+        preview_switch(highlighted);
+    }
+
+    // Visible windows not on the incoming workspace go, hidden windows on
+    // it come back; sticky windows are on every workspace and stay put,
+    // moving to the incoming workspace's MRU list as its least recent
+    switch_hide_.clear();
+    switch_show_.clear();
+    stacking_.for_each_bottom_up(windows_, [&](Window& window) {
+        if (window.is_sticky()) {
+            if (window.get_workspace() != workspace_index) {
+                if (Workspace* workspace = get_workspace_of(window)) {
+                    workspace->remove_window(windows_, window);
+                }
+                workspaces_[workspace_index]->add_window(windows_, window, false);
+                spatial_.set_workspace(window, workspace_index);
+                snap_edges_.set_workspace(window, workspace_index);
+            }
+            return;
+        }
+        bool incoming = window.get_workspace() == workspace_index;
+        if (incoming && window.is_hidden()) {
+            switch_show_.push_back(&window);
+        } else if (!incoming && !window.is_hidden()) {
+            switch_hide_.push_back(&window);
+        }
+    });
+
+    // Incoming frames are mapped top-down, so each one is only exposed
+    // where nothing already mapped covers it; outgoing frames are unmapped
+    // bottom-up, so none is exposed just before it disappears
+    for (auto it = switch_show_.rbegin(); it != switch_show_.rend(); ++it) {
+        (*it)->set_hidden(false);
+    }
+
+    // The switch is visible once the server has mapped every incoming
+    // frame; one still pending from an earlier switch is dropped
+    switch_start_ = batch_start_;
+    switch_unmapped_.clear();
+    for (Window* window : switch_show_) {
+        if (window->get_frame() && !window->is_minimized()) {
+            switch_unmapped_.push_back(window->get_frame());
+        }
+    }
+    switch_pending_ = true;
+    for (Window* window : switch_hide_) {
+        window->set_hidden(true);
+    }
+
+    workspaces_[current_workspace_]->set_active(false);
+    current_workspace_ = workspace_index;
+    workspaces_[current_workspace_]->set_active(true);
+    root_properties_->set_value(atoms().net_current_desktop, XA_CARDINAL, current_workspace_);
+
+    // Workspaces only differ in work area if a dock is on some of them
+    if (apply_work_areas()) {
+        on_outputs_changed();
+    }
+
+    // Focus returns to the incoming workspace's most recently used window,
+    // or with focus following the mouse to the window under the pointer,
+    // unless the focused one stayed visible
+    Window* focused = get_focused_window();
+    if (!focused || focused->is_hidden()) {
+        drop_focus(focused);
+        Window* recent = nullptr;
+        if (focus_mode_ != FocusMode::CLICK_TO_FOCUS) {
+            recent = get_window_under_pointer();
+        } else {
+            recent = windows_.get(workspaces_[current_workspace_]->get_most_recent());
+            while (recent && recent->is_minimized()) {
+                recent = windows_.get(Workspace::next_recent(*recent));
+            }
+        }
+        if (recent) {
+            focus_window(recent);
+        }
+    }
+
+    // One flush for the whole switch
+    XFlush(display_);
+
+    workspace_stats_.switches++;
+    workspace_stats_.hidden += switch_hide_.size();
+    workspace_stats_.shown += switch_show_.size();
+
+    // Nothing to map, or with nothing changed nothing to composite either
+    if (switch_unmapped_.empty() &&
+        (!compositor_ || (switch_show_.empty() && switch_hide_.empty()))) {
+        record_switch();
+    }
+}
+
+void WindowManager::note_switch_mapped(::Window frame) {
+    // Also called for frames going away, which are no longer waited for
+    auto it = std::find(switch_unmapped_.begin(), switch_unmapped_.end(), frame);
+    if (it == switch_unmapped_.end()) {
+        return;
+    }
+    switch_unmapped_.erase(it);
+
+    // With a compositor the frames only appear with the next presented frame
+    if (switch_unmapped_.empty() && switch_pending_ && !compositor_) {
+        record_switch();
+    }
+}
+
+void WindowManager::record_switch() {
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - switch_start_);
+    workspace_stats_.measured++;
+    workspace_stats_.total_latency += latency;
+    workspace_stats_.max_latency = std::max(workspace_stats_.max_latency, latency);
+    switch_pending_ = false;
 }
 
 int WindowManager::get_current_workspace() {
@@ -787,40 +1718,325 @@ int WindowManager::get_workspace_count() {
     return num_workspaces_;
 }
 
-void WindowManager::move_window_to_workspace(std::shared_ptr<Window> window, int workspace) {
-    // TODO: Implement
+void WindowManager::move_window_to_workspace(Window* window, int workspace) {
+    if (!window || workspace < 0 || workspace >= static_cast<int>(workspaces_.size()) ||
+        window->get_workspace() == workspace) {
+        return;
+    }
+
+    layouts_.window_removed(windows_, window->get_workspace(), *window);
+    if (Workspace* current = get_workspace_of(*window)) {
+        current->remove_window(windows_, *window);
+    }
+    workspaces_[workspace]->add_window(windows_, *window);
+    spatial_.set_workspace(*window, workspace);
+    snap_edges_.set_workspace(*window, workspace);
+    update_strut(*window);
+    layouts_.window_added(windows_, workspace, *window);
+
+    if (!window->is_sticky()) {
+        window->set_hidden(workspace != current_workspace_);
+        if (window->is_hidden() && focused_window_ == window->get_handle()) {
+            drop_focus(window);
+        }
+    }
 }
 
-void WindowManager::minimize_window(std::shared_ptr<Window> window) {
-    // TODO: Implement
+Workspace* WindowManager::get_workspace_of(const Window& window) {
+    int index = window.get_workspace();
+    if (index < 0 || index >= static_cast<int>(workspaces_.size())) {
+        return nullptr;
+    }
+    return workspaces_[index].get();
 }
 
-void WindowManager::unmaximize_window(std::shared_ptr<Window> window) {
-    // TODO: Implement
+void WindowManager::drop_focus(Window* window) {
+    if (!window || focused_window_ != window->get_handle()) {
+        return;
+    }
+
+    window->set_focused(false);
+    stacking_.update_layer(windows_, *window);
+    if (decorator_) {
+        decorator_->set_window_active(window, false);
+    }
+
+    focused_window_ = WindowHandle();
+    XSetInputFocus(display_, PointerRoot, RevertToPointerRoot, CurrentTime);
+    update_active_window();
 }
 
-void WindowManager::shade_window(std::shared_ptr<Window> window) {
+void WindowManager::minimize_window(Window* window) {
     // TODO: Implement
 }
 
-void WindowManager::fullscreen_window(std::shared_ptr<Window> window) {
+void WindowManager::unmaximize_window(Window* window) {
+    if (!window || !window->is_maximized()) {
+        return;
+    }
+
+    window->set_maximized(false, get_work_area_of(*window));
+    layouts_.window_added(windows_, window->get_workspace(), *window);
+    publish_state(window);
+}
+
+void WindowManager::shade_window(Window* window) {
     // TODO: Implement
 }
 
+void WindowManager::fullscreen_window(Window* window) {
+    if (!window) {
+        return;
+    }
+
+    // Toggles; the compositor unredirects the window once it is on top.
+    // Like maximized windows, fullscreen ones leave the layout meanwhile.
+    const OutputModel::Output& output = outputs_->get_output(outputs_->find(get_frame_rect(*window)));
+    bool fullscreen = !window->is_fullscreen();
+    if (fullscreen && !window->is_maximized()) {
+        layouts_.window_removed(windows_, window->get_workspace(), *window);
+    }
+    window->set_fullscreen(fullscreen, output.geometry);
+    if (!fullscreen && !window->is_maximized()) {
+        layouts_.window_added(windows_, window->get_workspace(), *window);
+    }
+    stacking_.update_layer(windows_, *window);
+    if (fullscreen) {
+        stacking_.raise(windows_, *window);
+    }
+    publish_state(window);
+}
+
+void WindowManager::publish_state(Window* window) {
+    // Once a window is managed its _NET_WM_STATE is the WM's to write
+    const Atoms& table = atoms();
+    std::vector<Atom> state;
+    if (window->is_modal()) state.push_back(table.net_wm_state_modal);
+    if (window->is_sticky()) state.push_back(table.net_wm_state_sticky);
+    if (window->is_maximized()) {
+        state.push_back(table.net_wm_state_maximized_vert);
+        state.push_back(table.net_wm_state_maximized_horz);
+    }
+    if (window->is_shaded()) state.push_back(table.net_wm_state_shaded);
+    if (window->is_skip_taskbar()) state.push_back(table.net_wm_state_skip_taskbar);
+    if (window->is_skip_pager()) state.push_back(table.net_wm_state_skip_pager);
+    if (window->is_minimized()) state.push_back(table.net_wm_state_hidden);
+    if (window->is_fullscreen()) state.push_back(table.net_wm_state_fullscreen);
+    if (window->is_above()) state.push_back(table.net_wm_state_above);
+    if (window->is_below()) state.push_back(table.net_wm_state_below);
+
+    XChangeProperty(display_, window->get_xwindow(), table.net_wm_state, XA_ATOM, 32,
+        PropModeReplace, reinterpret_cast<unsigned char*>(state.data()), state.size());
+}
+
 void WindowManager::show_desktop() {
     // TODO: Implement
 }
 
 void WindowManager::tile_windows_horizontally() {
-    // TODO: Implement
+    set_layout(Layout::Kind::TILE);
 }
 
 void WindowManager::tile_windows_vertically() {
-    // TODO: Implement
+    set_layout(Layout::Kind::COLUMNS);
 }
 
 void WindowManager::cascade_windows() {
-    // TODO: Implement
+    set_layout(Layout::Kind::CASCADE);
+}
+
+void WindowManager::set_layout(Layout::Kind kind) {
+    if (current_workspace_ < 0 || current_workspace_ >= static_cast<int>(workspaces_.size())) {
+        return;
+    }
+    layouts_.set_layout(windows_, *workspaces_[current_workspace_], kind, get_work_area());
+}
+
+Layout::Rect WindowManager::get_work_area() const {
+    // Layouts arrange the primary output
+    return outputs_->get_output(outputs_->get_primary()).work_area;
+}
+
+const Layout::Rect& WindowManager::get_work_area_of(const Window& window) const {
+    return outputs_->get_output(outputs_->find(get_frame_rect(window))).work_area;
+}
+
+void WindowManager::apply_outputs() {
+    std::vector<Layout::Rect> areas;
+    std::vector<XRectangle> rects;
+    for (const OutputModel::Output& output : outputs_->get_outputs()) {
+        areas.push_back(output.work_area);
+        rects.push_back(XRectangle{ static_cast<short>(output.geometry.x),
+            static_cast<short>(output.geometry.y),
+            static_cast<unsigned short>(output.geometry.width),
+            static_cast<unsigned short>(output.geometry.height) });
+    }
+    snap_edges_.set_bounds(areas);
+    if (compositor_) {
+        compositor_->set_outputs(rects);
+    }
+}
+
+void WindowManager::on_outputs_changed() {
+    apply_outputs();
+
+    // Windows keep their place unless their output went away; maximized
+    // and fullscreen windows are fitted to the output they are now on
+    stacking_.for_each_bottom_up(windows_, [&](Window& window) {
+        Layout::Rect frame = get_frame_rect(window);
+        const OutputModel::Output& output = outputs_->get_output(outputs_->find(frame));
+        if (window.is_fullscreen()) {
+            if (!(frame == output.geometry)) {
+                window.set_fullscreen(true, output.geometry);
+            }
+        } else if (window.is_maximized()) {
+            if (!(frame == output.work_area)) {
+                window.set_maximized(true, output.work_area);
+            }
+        } else if (!outputs_->contains(frame.x + frame.width / 2, frame.y + frame.height / 2)) {
+            const Layout::Rect& area = output.work_area;
+            window.move(std::max(area.x, std::min(frame.x, area.x + area.width - frame.width)),
+                        std::max(area.y, std::min(frame.y, area.y + area.height - frame.height)));
+        }
+    });
+
+    int primary = outputs_->get_primary();
+    for (size_t i = 0; i < workspaces_.size(); ++i) {
+        layouts_.set_area(windows_, i, work_areas_.get(i, primary));
+    }
+}
+
+void WindowManager::update_strut(Window& window) {
+    if (window.is_minimized()) {
+        work_areas_.remove(window.get_handle());
+        return;
+    }
+    work_areas_.set_strut(window.get_handle(), window.get_strut(),
+        window.is_sticky() ? WorkAreas::ALL_WORKSPACES : window.get_workspace());
+}
+
+bool WindowManager::compute_work_areas() {
+    std::vector<Layout::Rect> geometries;
+    for (const OutputModel::Output& output : outputs_->get_outputs()) {
+        geometries.push_back(output.geometry);
+    }
+    Layout::Rect screen{ 0, 0, DisplayWidth(display_, screen_), DisplayHeight(display_, screen_) };
+    if (!work_areas_.compute(geometries, screen, workspaces_.size())) {
+        // Rebuilt outputs start from their full geometry again
+        return apply_work_areas();
+    }
+
+    // _NET_WORKAREA holds one rectangle per desktop; the publisher only
+    // writes it if it differs from what was last published
+    std::vector<unsigned long> workarea;
+    for (size_t i = 0; i < workspaces_.size(); ++i) {
+        const Layout::Rect& area = work_areas_.get_desktop(i);
+        workarea.insert(workarea.end(), { static_cast<unsigned long>(area.x),
+            static_cast<unsigned long>(area.y), static_cast<unsigned long>(area.width),
+            static_cast<unsigned long>(area.height) });
+    }
+    root_properties_->set_list(atoms().net_workarea, XA_CARDINAL, workarea);
+
+    apply_work_areas();
+    return true;
+}
+
+bool WindowManager::apply_work_areas() {
+    bool changed = false;
+    for (size_t i = 0; i < outputs_->get_outputs().size(); ++i) {
+        changed |= outputs_->set_work_area(i, work_areas_.get(current_workspace_, i));
+    }
+    return changed;
+}
+
+Layout::Rect WindowManager::get_frame_rect(const Window& window) const {
+    Layout::Rect rect;
+    window.get_frame_geometry(rect.x, rect.y, rect.width, rect.height);
+    return rect;
+}
+
+void WindowManager::place_window(Window* window) {
+    if ((window->get_type() != Window::Type::NORMAL && window->get_type() != Window::Type::DIALOG &&
+         window->get_type() != Window::Type::UTILITY) ||
+        window->is_maximized() || window->is_fullscreen()) {
+        return;
+    }
+
+    // New windows open on the output of the window in use
+    Window* focused = get_focused_window();
+    Layout::Rect area = focused && focused != window ? get_work_area_of(*focused) : get_work_area();
+    Layout::Rect frame = get_frame_rect(*window);
+    int x = frame.x;
+    int y = frame.y;
+    switch (placement_mode_) {
+        case PlacementMode::SMART:
+            placement_.place_smart(spatial_, windows_, window->get_workspace(), area,
+                frame.width, frame.height, window->get_handle(), x, y);
+            break;
+
+        case PlacementMode::CENTER:
+            x = area.x + (area.width - frame.width) / 2;
+            y = area.y + (area.height - frame.height) / 2;
+            break;
+
+        case PlacementMode::CASCADE: {
+            // One titlebar down and right of the previously used window,
+            // back to the corner once that would leave the work area
+            x = area.x;
+            y = area.y;
+            if (Window* previous = windows_.get(Workspace::next_recent(*window))) {
+                Layout::Rect last = get_frame_rect(*previous);
+                int step = window->get_titlebar_height();
+                if (last.x + step + frame.width <= area.x + area.width &&
+                    last.y + step + frame.height <= area.y + area.height) {
+                    x = last.x + step;
+                    y = last.y + step;
+                }
+            }
+            break;
+        }
+
+        case PlacementMode::RANDOM:
+            x = area.x + std::rand() % std::max(1, area.width - frame.width + 1);
+            y = area.y + std::rand() % std::max(1, area.height - frame.height + 1);
+            break;
+    }
+
+    window->move(std::max(x, area.x), std::max(y, area.y));
+}
+
+Window* WindowManager::window_at(int x, int y) {
+    // The index narrows the search to the frames around the point; the
+    // stacking ranks pick the top one among them
+    Window* top = nullptr;
+    spatial_.query(current_workspace_, Layout::Rect{ x, y, 1, 1 },
+        [&](WindowHandle handle, const Layout::Rect&) {
+            Window* window = windows_.get(handle);
+            if (!window || window->is_minimized() || window->is_hidden()) {
+                return;
+            }
+            if (!top || stacking_.get_rank(windows_, *window) > stacking_.get_rank(windows_, *top)) {
+                top = window;
+            }
+        });
+    return top;
+}
+
+Window* WindowManager::get_window_under_pointer() {
+    ::Window root, child;
+    int root_x, root_y, window_x, window_y;
+    unsigned int mask;
+    if (!XQueryPointer(display_, root_, &root, &child, &root_x, &root_y,
+            &window_x, &window_y, &mask)) {
+        return nullptr;
+    }
+
+    // Desktop windows cover the screen but never take focus this way
+    Window* window = window_at(root_x, root_y);
+    if (window && window->get_type() == Window::Type::DESKTOP) {
+        return nullptr;
+    }
+    return window;
 }
 
 void WindowManager::load_config() {
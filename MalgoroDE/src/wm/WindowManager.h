@@ -1,12 +1,23 @@
 #ifndef MALGORO_WINDOW_MANAGER_H
 #define MALGORO_WINDOW_MANAGER_H
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include "WindowStore.h"
+#include "Stacking.h"
+#include "EdgeIndex.h"
+#include "FramePool.h"
+#include "LayoutEngine.h"
+#include "Placement.h"
+#include "SpatialIndex.h"
+#include "WorkAreas.h"
+#include "WindowProperties.h"
 
 namespace MalgoroDE {
 
@@ -15,6 +26,11 @@ class Window;
 class Workspace;
 class Decorator;
 class KeyBindings;
+class RootPropertyPublisher;
+class MoveResize;
+class Compositor;
+class OutputModel;
+class WindowSwitcher;
 
 /**
  * @brief Main window manager class
@@ -46,28 +62,32 @@ public:
     // Window management
     bool manage_window(::Window xwindow);
     bool unmanage_window(::Window xwindow);
-    std::shared_ptr<Window> find_window(::Window xwindow);
-    std::vector<std::shared_ptr<Window>> get_all_windows();
+    Window* find_window(::Window xwindow);
+    WindowStore& get_all_windows() { return windows_; }
 
     // Focus management
-    void focus_window(std::shared_ptr<Window> window);
-    std::shared_ptr<Window> get_focused_window();
+    void focus_window(Window* window);
+    Window* get_focused_window();
     void cycle_focus(bool reverse = false);
 
+    // Stacking
+    void raise_window(Window* window);
+    void lower_window(Window* window);
+
     // Workspace management
     void switch_workspace(int workspace_index);
     int get_current_workspace();
     int get_workspace_count();
-    void move_window_to_workspace(std::shared_ptr<Window> window, int workspace);
+    void move_window_to_workspace(Window* window, int workspace);
 
     // Window operations
-    void close_window(std::shared_ptr<Window> window);
-    void minimize_window(std::shared_ptr<Window> window);
-    void maximize_window(std::shared_ptr<Window> window);
-    void unmaximize_window(std::shared_ptr<Window> window);
-    void toggle_maximize(std::shared_ptr<Window> window);
-    void shade_window(std::shared_ptr<Window> window);
-    void fullscreen_window(std::shared_ptr<Window> window);
+    void close_window(Window* window);
+    void minimize_window(Window* window);
+    void maximize_window(Window* window);
+    void unmaximize_window(Window* window);
+    void toggle_maximize(Window* window);
+    void shade_window(Window* window);
+    void fullscreen_window(Window* window);
 
     // Desktop operations
     void show_desktop();
@@ -75,6 +95,20 @@ public:
     void tile_windows_vertically();
     void cascade_windows();
 
+    /**
+     * @brief Arrange the current workspace, or stop arranging it with Kind::NONE
+     *
+     * The layout stays in effect: windows added to or removed from the
+     * workspace are fitted in incrementally.
+     */
+    void set_layout(Layout::Kind kind);
+
+    /**
+     * @brief Topmost visible window on the current workspace at a root
+     *        position, or nullptr
+     */
+    Window* window_at(int x, int y);
+
     // Configuration
     void load_config();
     void save_config();
@@ -84,12 +118,63 @@ public:
     Display* get_display() { return display_; }
     ::Window get_root_window() { return root_; }
 
+    // Compositing (takes effect at initialize())
+    void set_compositor_enabled(bool enabled) { enable_compositor_ = enabled; }
+    bool is_compositing() const { return compositor_ != nullptr; }
+
     // Theme
     void set_theme(const std::string& theme_name);
     std::string get_theme() const { return current_theme_; }
 
+    /**
+     * @brief Event loop counters
+     *
+     * The *_collapsed counters report events that were dropped because a
+     * later event in the same batch superseded them.
+     */
+    struct EventStats {
+        unsigned long batches = 0;
+        unsigned long received = 0;
+        unsigned long dispatched = 0;
+        unsigned long largest_batch = 0;
+        unsigned long motion_collapsed = 0;
+        unsigned long configure_collapsed = 0;
+        unsigned long property_collapsed = 0;
+    };
+    const EventStats& get_event_stats() const { return event_stats_; }
+
+    /**
+     * @brief Workspace switch counters
+     *
+     * Latency runs from reading the event batch holding the switch request
+     * (key press or pager message) until the server reports the last
+     * incoming frame mapped, and with a compositor until the next frame is
+     * presented. A switch superseded before that is not measured.
+     */
+    struct WorkspaceStats {
+        unsigned long switches = 0;
+        unsigned long measured = 0;
+        unsigned long hidden = 0;
+        unsigned long shown = 0;
+        std::chrono::microseconds total_latency{0};
+        std::chrono::microseconds max_latency{0};
+    };
+    const WorkspaceStats& get_workspace_stats() const { return workspace_stats_; }
+
+    /**
+     * @brief Print window manager statistics to stdout
+     */
+    void print_stats() const;
+
 private:
     // X11 event handling
+    bool wait_for_events(int timeout_ms);
+    void process_event_batch();
+    void coalesce_event_batch();
+    void finish_event_batch();
+    void paint_frame();
+    void note_switch_mapped(::Window frame);
+    void record_switch();
     void handle_event(XEvent& event);
     void handle_map_request(XMapRequestEvent& event);
     void handle_unmap_notify(XUnmapEvent& event);
@@ -101,6 +186,7 @@ private:
     void handle_button_press(XButtonEvent& event);
     void handle_button_release(XButtonEvent& event);
     void handle_motion_notify(XMotionEvent& event);
+    void handle_expose(XExposeEvent& event);
     void handle_key_press(XKeyEvent& event);
     void handle_key_release(XKeyEvent& event);
     void handle_enter_notify(XCrossingEvent& event);
@@ -112,7 +198,26 @@ private:
     void update_window_list();
     void update_client_list();
     void update_active_window();
+    void commit_stacking();
+    void refresh_dirty_properties();
+    void on_properties_changed(Window* window, unsigned int changed);
+    void update_visible_name(Window* window);
+    void release_title_number(Window& window);
+    void publish_state(Window* window);
     void update_desktop_names();
+    void drop_focus(Window* window);
+    Workspace* get_workspace_of(const Window& window);
+    void preview_switch(WindowHandle previous);
+    Layout::Rect get_work_area() const;
+    const Layout::Rect& get_work_area_of(const Window& window) const;
+    void apply_outputs();
+    void on_outputs_changed();
+    void update_strut(Window& window);
+    bool compute_work_areas();
+    bool apply_work_areas();
+    void place_window(Window* window);
+    Layout::Rect get_frame_rect(const Window& window) const;
+    Window* get_window_under_pointer();
 
     // EWMH (Extended Window Manager Hints) support
     void setup_ewmh();
@@ -132,18 +237,42 @@ private:
     void grab_keys();
     void grab_buttons();
     void scan_existing_windows();
+    bool adopt_window(::Window xwindow, const WindowProperties& props);
+    void check_adopted_windows();
 
     // Data members
     Display* display_;
     ::Window root_;
     int screen_;
 
-    std::map<::Window, std::shared_ptr<Window>> windows_;
+    WindowStore windows_;
+    Stacking stacking_;
+    LayoutEngine layouts_;
+    SpatialIndex spatial_;          // Frame rectangles, updated on ConfigureNotify
+    EdgeIndex snap_edges_;          // Frame edges for move snapping, updated alike
+    WorkAreas work_areas_;          // Output areas left by struts, per workspace
+    Placement placement_;
+    std::vector<::Window> stacking_clients_;
     std::vector<std::shared_ptr<Workspace>> workspaces_;
     int current_workspace_;
-
-    std::shared_ptr<Window> focused_window_;
+    std::vector<Window*> switch_hide_;      // Scratch buffers for switch_workspace()
+    std::vector<Window*> switch_show_;
+    WorkspaceStats workspace_stats_;
+    std::chrono::steady_clock::time_point switch_start_;
+    std::vector<::Window> switch_unmapped_;     // Incoming frames not yet reported mapped
+    bool switch_pending_ = false;               // Last switch not yet visible
+
+    WindowHandle focused_window_;
+    std::vector<::Window> client_list_;     // Mapping order, for _NET_CLIENT_LIST
+    std::unique_ptr<RootPropertyPublisher> root_properties_;
+    std::unordered_map<std::string, std::vector<bool>> title_numbers_;  // " <N>" suffixes taken per title
     std::unique_ptr<Decorator> decorator_;
+    std::unique_ptr<MoveResize> move_resize_;
+    std::unique_ptr<WindowSwitcher> switcher_;
+    std::unique_ptr<Compositor> compositor_;
+    std::unique_ptr<OutputModel> outputs_;
+    std::unique_ptr<FramePool> frame_pool_;
+    unsigned long unredirect_serial_ = 0;   // Last published unredirected set
     std::unique_ptr<KeyBindings> key_bindings_;
 
     // Configuration
@@ -174,55 +303,22 @@ private:
     bool running_;
     bool show_desktop_mode_;
 
-    // Atoms (X11 properties)
-    struct Atoms {
-        Atom wm_protocols;
-        Atom wm_delete_window;
-        Atom wm_state;
-        Atom wm_change_state;
-        Atom wm_take_focus;
-
-        // EWMH atoms
-        Atom net_supported;
-        Atom net_client_list;
-        Atom net_client_list_stacking;
-        Atom net_number_of_desktops;
-        Atom net_desktop_geometry;
-        Atom net_desktop_viewport;
-        Atom net_current_desktop;
-        Atom net_desktop_names;
-        Atom net_active_window;
-        Atom net_workarea;
-        Atom net_supporting_wm_check;
-        Atom net_wm_name;
-        Atom net_wm_state;
-        Atom net_wm_state_modal;
-        Atom net_wm_state_sticky;
-        Atom net_wm_state_maximized_vert;
-        Atom net_wm_state_maximized_horz;
-        Atom net_wm_state_shaded;
-        Atom net_wm_state_skip_taskbar;
-        Atom net_wm_state_skip_pager;
-        Atom net_wm_state_hidden;
-        Atom net_wm_state_fullscreen;
-        Atom net_wm_state_above;
-        Atom net_wm_state_below;
-        Atom net_wm_window_type;
-        Atom net_wm_window_type_desktop;
-        Atom net_wm_window_type_dock;
-        Atom net_wm_window_type_toolbar;
-        Atom net_wm_window_type_menu;
-        Atom net_wm_window_type_utility;
-        Atom net_wm_window_type_splash;
-        Atom net_wm_window_type_dialog;
-        Atom net_wm_window_type_normal;
-        Atom net_close_window;
-        Atom net_moveresize_window;
-        Atom net_wm_moveresize;
-    };
-    Atoms atoms_;
-
-    void init_atoms();
+    // Event batching
+    std::vector<XEvent> event_batch_;
+    std::chrono::steady_clock::time_point batch_start_;  // First event of the batch read
+    std::unordered_set<::Window> seen_motion_;
+    std::unordered_map<::Window, size_t> seen_configure_;
+    std::unordered_set<unsigned long long> seen_property_;
+    EventStats event_stats_;
+
+    // Windows adopted by the startup scan, checked once the events the
+    // adoption caused (the first adoption_events_ received) are handled
+    std::vector<WindowHandle> adopted_windows_;
+    unsigned long adoption_events_ = 0;
+
+    // Windows with properties awaiting refresh at end of batch
+    std::vector<WindowHandle> dirty_windows_;
+    std::vector<PropertyFetch> property_fetches_;
 };
 
 } // namespace MalgoroDE
@@ -0,0 +1,381 @@
+#include "WindowProperties.h"
+#include "Atoms.h"
+#include <X11/Xlib-xcb.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace MalgoroDE {
+
+namespace {
+
+template <typename T>
+using Reply = std::unique_ptr<T, decltype(&std::free)>;
+
+template <typename T>
+Reply<T> make_reply(T* reply) {
+    return Reply<T>(reply, &std::free);
+}
+
+xcb_get_property_cookie_t request_property(xcb_connection_t* conn, ::Window window,
+                                           xcb_atom_t property, xcb_atom_t type,
+                                           uint32_t long_length) {
+    return xcb_get_property(conn, 0, window, property, type, 0, long_length);
+}
+
+Reply<xcb_get_property_reply_t> property_reply(xcb_connection_t* conn,
+                                               xcb_get_property_cookie_t cookie) {
+    // Errors for windows that vanished mid-fetch are expected; consume them
+    // here instead of letting them reach the Xlib error handler
+    xcb_generic_error_t* error = nullptr;
+    auto reply = make_reply(xcb_get_property_reply(conn, cookie, &error));
+    std::free(error);
+    if (reply && (reply->type == XCB_ATOM_NONE || reply->value_len == 0)) {
+        reply.reset();
+    }
+    return reply;
+}
+
+std::string property_string(xcb_get_property_reply_t* reply) {
+    const char* value = static_cast<const char*>(xcb_get_property_value(reply));
+    int length = xcb_get_property_value_length(reply);
+    return std::string(value, strnlen(value, length));
+}
+
+void property_atoms(xcb_get_property_reply_t* reply, std::vector<Atom>& atoms) {
+    atoms.clear();
+    if (reply->format != 32) {
+        return;
+    }
+    const uint32_t* values = static_cast<const uint32_t*>(xcb_get_property_value(reply));
+    int count = xcb_get_property_value_length(reply) / 4;
+    atoms.assign(values, values + count);
+}
+
+// PropertyNotify dispatch: atom -> field. Predefined atoms are constants,
+// the rest come from the shared atom table.
+struct PropertyFieldEntry {
+    Atom Atoms::*atom;
+    Atom predefined;
+    unsigned int field;
+};
+
+const PropertyFieldEntry property_fields[] = {
+    { &Atoms::net_wm_name, None, WindowProperties::TITLE },
+    { nullptr, XA_WM_NAME, WindowProperties::TITLE },
+    { nullptr, XA_WM_CLASS, WindowProperties::CLASS },
+    { nullptr, XA_WM_HINTS, WindowProperties::HINTS },
+    { nullptr, XA_WM_NORMAL_HINTS, WindowProperties::SIZE_HINTS },
+    { &Atoms::wm_protocols, None, WindowProperties::PROTOCOLS },
+    { &Atoms::net_wm_state, None, WindowProperties::STATE },
+    { &Atoms::net_wm_window_type, None, WindowProperties::TYPE },
+    { &Atoms::net_wm_sync_request_counter, None, WindowProperties::SYNC_COUNTER },
+    { &Atoms::net_wm_strut_partial, None, WindowProperties::STRUT },
+    { &Atoms::net_wm_strut, None, WindowProperties::STRUT },
+};
+
+} // namespace
+
+unsigned int property_field(Atom property) {
+    const Atoms& table = atoms();
+    for (const PropertyFieldEntry& entry : property_fields) {
+        Atom atom = entry.atom ? table.*entry.atom : entry.predefined;
+        if (atom == property) {
+            return entry.field;
+        }
+    }
+    return 0;
+}
+
+PropertyFetch::PropertyFetch(Display* display, ::Window window, unsigned int fields)
+    : conn_(XGetXCBConnection(display))
+    , window_(window)
+    , fields_(fields)
+    , pending_(true)
+{
+    if (fields_ & WindowProperties::ATTRIBUTES) {
+        attributes_cookie_ = xcb_get_window_attributes(conn_, window_);
+        geometry_cookie_ = xcb_get_geometry(conn_, window_);
+    }
+    if (fields_ & WindowProperties::TITLE) {
+        net_wm_name_cookie_ = request_property(conn_, window_,
+            atoms().net_wm_name, atoms().utf8_string, 1024);
+        wm_name_cookie_ = request_property(conn_, window_,
+            XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, 1024);
+    }
+    if (fields_ & WindowProperties::CLASS) {
+        class_cookie_ = request_property(conn_, window_,
+            XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 256);
+    }
+    if (fields_ & WindowProperties::HINTS) {
+        hints_cookie_ = request_property(conn_, window_,
+            XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, 9);
+    }
+    if (fields_ & WindowProperties::SIZE_HINTS) {
+        size_hints_cookie_ = request_property(conn_, window_,
+            XCB_ATOM_WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 18);
+    }
+    if (fields_ & WindowProperties::PROTOCOLS) {
+        protocols_cookie_ = request_property(conn_, window_,
+            atoms().wm_protocols, XCB_ATOM_ATOM, 32);
+    }
+    if (fields_ & WindowProperties::STATE) {
+        state_cookie_ = request_property(conn_, window_,
+            atoms().net_wm_state, XCB_ATOM_ATOM, 32);
+    }
+    if (fields_ & WindowProperties::TYPE) {
+        type_cookie_ = request_property(conn_, window_,
+            atoms().net_wm_window_type, XCB_ATOM_ATOM, 32);
+    }
+    if (fields_ & WindowProperties::SYNC_COUNTER) {
+        sync_counter_cookie_ = request_property(conn_, window_,
+            atoms().net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 1);
+    }
+    if (fields_ & WindowProperties::STRUT) {
+        strut_partial_cookie_ = request_property(conn_, window_,
+            atoms().net_wm_strut_partial, XCB_ATOM_CARDINAL, 12);
+        strut_cookie_ = request_property(conn_, window_,
+            atoms().net_wm_strut, XCB_ATOM_CARDINAL, 4);
+    }
+}
+
+PropertyFetch::PropertyFetch(PropertyFetch&& other) noexcept
+    : conn_(other.conn_)
+    , window_(other.window_)
+    , fields_(other.fields_)
+    , pending_(other.pending_)
+    , attributes_cookie_(other.attributes_cookie_)
+    , geometry_cookie_(other.geometry_cookie_)
+    , net_wm_name_cookie_(other.net_wm_name_cookie_)
+    , wm_name_cookie_(other.wm_name_cookie_)
+    , class_cookie_(other.class_cookie_)
+    , hints_cookie_(other.hints_cookie_)
+    , size_hints_cookie_(other.size_hints_cookie_)
+    , protocols_cookie_(other.protocols_cookie_)
+    , state_cookie_(other.state_cookie_)
+    , type_cookie_(other.type_cookie_)
+    , sync_counter_cookie_(other.sync_counter_cookie_)
+    , strut_partial_cookie_(other.strut_partial_cookie_)
+    , strut_cookie_(other.strut_cookie_)
+{
+    other.pending_ = false;
+}
+
+PropertyFetch::~PropertyFetch() {
+    discard();
+}
+
+void PropertyFetch::discard() {
+    if (!pending_) {
+        return;
+    }
+    pending_ = false;
+
+    // Replies nobody will read must still be released by XCB
+    if (fields_ & WindowProperties::ATTRIBUTES) {
+        xcb_discard_reply(conn_, attributes_cookie_.sequence);
+        xcb_discard_reply(conn_, geometry_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::TITLE) {
+        xcb_discard_reply(conn_, net_wm_name_cookie_.sequence);
+        xcb_discard_reply(conn_, wm_name_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::CLASS) {
+        xcb_discard_reply(conn_, class_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::HINTS) {
+        xcb_discard_reply(conn_, hints_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::SIZE_HINTS) {
+        xcb_discard_reply(conn_, size_hints_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::PROTOCOLS) {
+        xcb_discard_reply(conn_, protocols_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::STATE) {
+        xcb_discard_reply(conn_, state_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::TYPE) {
+        xcb_discard_reply(conn_, type_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::SYNC_COUNTER) {
+        xcb_discard_reply(conn_, sync_counter_cookie_.sequence);
+    }
+    if (fields_ & WindowProperties::STRUT) {
+        xcb_discard_reply(conn_, strut_partial_cookie_.sequence);
+        xcb_discard_reply(conn_, strut_cookie_.sequence);
+    }
+}
+
+bool PropertyFetch::collect(WindowProperties& props) {
+    if (!pending_) {
+        return false;
+    }
+
+    bool alive = true;
+
+    if (fields_ & WindowProperties::ATTRIBUTES) {
+        xcb_generic_error_t* attrs_error = nullptr;
+        xcb_generic_error_t* geometry_error = nullptr;
+        auto attrs = make_reply(xcb_get_window_attributes_reply(conn_, attributes_cookie_, &attrs_error));
+        auto geometry = make_reply(xcb_get_geometry_reply(conn_, geometry_cookie_, &geometry_error));
+        std::free(attrs_error);
+        std::free(geometry_error);
+        if (attrs && geometry) {
+            props.override_redirect = attrs->override_redirect;
+            props.viewable = attrs->map_state == XCB_MAP_STATE_VIEWABLE;
+            props.x = geometry->x;
+            props.y = geometry->y;
+            props.width = geometry->width;
+            props.height = geometry->height;
+        } else {
+            alive = false;
+        }
+    }
+
+    if (fields_ & WindowProperties::TITLE) {
+        auto net_wm_name = property_reply(conn_, net_wm_name_cookie_);
+        auto wm_name = property_reply(conn_, wm_name_cookie_);
+        if (net_wm_name) {
+            props.title = property_string(net_wm_name.get());
+        } else if (wm_name) {
+            props.title = property_string(wm_name.get());
+        } else {
+            props.title = "Untitled";
+        }
+    }
+
+    if (fields_ & WindowProperties::CLASS) {
+        // WM_CLASS is "instance\0class\0"
+        if (auto reply = property_reply(conn_, class_cookie_)) {
+            const char* value = static_cast<const char*>(xcb_get_property_value(reply.get()));
+            size_t length = xcb_get_property_value_length(reply.get());
+            size_t instance_length = strnlen(value, length);
+            props.instance.assign(value, instance_length);
+            if (instance_length + 1 < length) {
+                const char* class_name = value + instance_length + 1;
+                props.class_name.assign(class_name,
+                    strnlen(class_name, length - instance_length - 1));
+            }
+        }
+    }
+
+    if (fields_ & WindowProperties::HINTS) {
+        auto reply = property_reply(conn_, hints_cookie_);
+        if (reply && xcb_get_property_value_length(reply.get()) >= 8) {
+            const uint32_t* hints = static_cast<const uint32_t*>(xcb_get_property_value(reply.get()));
+            props.accepts_input = !(hints[0] & InputHint) || hints[1];
+            props.urgent = hints[0] & XUrgencyHint;
+        }
+    }
+
+    if (fields_ & WindowProperties::SIZE_HINTS) {
+        // WM_SIZE_HINTS: flags, 4 obsolete fields, min, max, inc,
+        // min_aspect, max_aspect, base, gravity
+        auto reply = property_reply(conn_, size_hints_cookie_);
+        if (reply && xcb_get_property_value_length(reply.get()) >= 15 * 4) {
+            const uint32_t* hints = static_cast<const uint32_t*>(xcb_get_property_value(reply.get()));
+            const int32_t* values = reinterpret_cast<const int32_t*>(hints);
+            props.size_flags = hints[0];
+            props.min_width = values[5];
+            props.min_height = values[6];
+            props.max_width = values[7];
+            props.max_height = values[8];
+            props.width_inc = values[9];
+            props.height_inc = values[10];
+            props.min_aspect_x = values[11];
+            props.min_aspect_y = values[12];
+            props.max_aspect_x = values[13];
+            props.max_aspect_y = values[14];
+            if (xcb_get_property_value_length(reply.get()) >= 17 * 4) {
+                props.base_width = values[15];
+                props.base_height = values[16];
+            } else {
+                props.size_flags &= ~PBaseSize;
+            }
+        }
+    }
+
+    if (fields_ & WindowProperties::PROTOCOLS) {
+        props.supports_delete = false;
+        props.supports_take_focus = false;
+        props.supports_sync_request = false;
+        if (auto reply = property_reply(conn_, protocols_cookie_)) {
+            std::vector<Atom> protocols;
+            property_atoms(reply.get(), protocols);
+            for (Atom protocol : protocols) {
+                if (protocol == atoms().wm_delete_window) {
+                    props.supports_delete = true;
+                } else if (protocol == atoms().wm_take_focus) {
+                    props.supports_take_focus = true;
+                } else if (protocol == atoms().net_wm_sync_request) {
+                    props.supports_sync_request = true;
+                }
+            }
+        }
+    }
+
+    if (fields_ & WindowProperties::STATE) {
+        props.state.clear();
+        if (auto reply = property_reply(conn_, state_cookie_)) {
+            property_atoms(reply.get(), props.state);
+        }
+    }
+
+    if (fields_ & WindowProperties::TYPE) {
+        props.types.clear();
+        if (auto reply = property_reply(conn_, type_cookie_)) {
+            property_atoms(reply.get(), props.types);
+        }
+    }
+
+    if (fields_ & WindowProperties::SYNC_COUNTER) {
+        props.sync_counter = None;
+        auto reply = property_reply(conn_, sync_counter_cookie_);
+        if (reply && reply->format == 32) {
+            props.sync_counter = *static_cast<const uint32_t*>(xcb_get_property_value(reply.get()));
+        }
+    }
+
+    if (fields_ & WindowProperties::STRUT) {
+        props.strut = Strut();
+        auto partial = property_reply(conn_, strut_partial_cookie_);
+        auto plain = property_reply(conn_, strut_cookie_);
+        if (partial && partial->format == 32 && xcb_get_property_value_length(partial.get()) >= 48) {
+            const uint32_t* value = static_cast<const uint32_t*>(xcb_get_property_value(partial.get()));
+            Strut& strut = props.strut;
+            strut.left = value[0];
+            strut.right = value[1];
+            strut.top = value[2];
+            strut.bottom = value[3];
+            strut.left_start_y = value[4];
+            strut.left_end_y = value[5];
+            strut.right_start_y = value[6];
+            strut.right_end_y = value[7];
+            strut.top_start_x = value[8];
+            strut.top_end_x = value[9];
+            strut.bottom_start_x = value[10];
+            strut.bottom_end_x = value[11];
+        } else if (plain && plain->format == 32 && xcb_get_property_value_length(plain.get()) >= 16) {
+            const uint32_t* value = static_cast<const uint32_t*>(xcb_get_property_value(plain.get()));
+            Strut& strut = props.strut;
+            strut.left = value[0];
+            strut.right = value[1];
+            strut.top = value[2];
+            strut.bottom = value[3];
+            strut.left_end_y = strut.right_end_y = INT_MAX;
+            strut.top_end_x = strut.bottom_end_x = INT_MAX;
+        }
+    }
+
+    pending_ = false;
+    if (alive) {
+        props.fields |= fields_;
+    }
+    return alive;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,152 @@
+#ifndef MALGORO_WINDOW_PROPERTIES_H
+#define MALGORO_WINDOW_PROPERTIES_H
+
+#include <string>
+#include <vector>
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Space a dock reserves along the screen edges
+ *
+ * Fields in _NET_WM_STRUT_PARTIAL order, in root coordinates. A plain
+ * _NET_WM_STRUT reserves its edges along their whole length.
+ */
+struct Strut {
+    long left = 0, right = 0, top = 0, bottom = 0;
+    long left_start_y = 0, left_end_y = 0;
+    long right_start_y = 0, right_end_y = 0;
+    long top_start_x = 0, top_end_x = 0;
+    long bottom_start_x = 0, bottom_end_x = 0;
+
+    bool is_empty() const { return left <= 0 && right <= 0 && top <= 0 && bottom <= 0; }
+    bool operator==(const Strut& other) const = default;
+};
+
+/**
+ * @brief Snapshot of a client window's attributes and ICCCM/EWMH properties
+ *
+ * Only the groups listed in @c fields hold meaningful values.
+ */
+struct WindowProperties {
+    enum Field : unsigned int {
+        ATTRIBUTES  = 1 << 0,   // Geometry, map state, override-redirect
+        TITLE       = 1 << 1,   // _NET_WM_NAME, falling back to WM_NAME
+        CLASS       = 1 << 2,   // WM_CLASS
+        HINTS       = 1 << 3,   // WM_HINTS
+        SIZE_HINTS  = 1 << 4,   // WM_NORMAL_HINTS
+        PROTOCOLS   = 1 << 5,   // WM_PROTOCOLS
+        STATE       = 1 << 6,   // _NET_WM_STATE
+        TYPE        = 1 << 7,   // _NET_WM_WINDOW_TYPE
+        SYNC_COUNTER = 1 << 8,  // _NET_WM_SYNC_REQUEST_COUNTER
+        STRUT       = 1 << 9,   // _NET_WM_STRUT_PARTIAL, falling back to _NET_WM_STRUT
+
+        ALL = ATTRIBUTES | TITLE | CLASS | HINTS | SIZE_HINTS |
+              PROTOCOLS | STATE | TYPE | SYNC_COUNTER | STRUT
+    };
+
+    unsigned int fields = 0;
+
+    // ATTRIBUTES
+    bool override_redirect = false;
+    bool viewable = false;
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+
+    // TITLE
+    std::string title;
+
+    // CLASS
+    std::string class_name;
+    std::string instance;
+
+    // HINTS
+    bool accepts_input = true;
+    bool urgent = false;
+
+    // SIZE_HINTS (flags use the Xutil.h P* bits)
+    long size_flags = 0;
+    int min_width = 0, min_height = 0;
+    int max_width = 0, max_height = 0;
+    int base_width = 0, base_height = 0;
+    int width_inc = 0, height_inc = 0;
+    int min_aspect_x = 0, min_aspect_y = 0;
+    int max_aspect_x = 0, max_aspect_y = 0;
+
+    // PROTOCOLS
+    bool supports_delete = false;
+    bool supports_take_focus = false;
+    bool supports_sync_request = false;
+
+    // STATE
+    std::vector<Atom> state;
+
+    // TYPE (in the client's order of preference)
+    std::vector<Atom> types;
+
+    // SYNC_COUNTER (an XSyncCounter, or None)
+    XID sync_counter = None;
+
+    // STRUT
+    Strut strut;
+};
+
+/**
+ * @brief Field a property atom feeds (0 for properties the WM ignores)
+ */
+unsigned int property_field(Atom property);
+
+/**
+ * @brief Pipelined fetch of window properties over XCB
+ *
+ * The constructor sends every request needed for the selected fields
+ * without waiting for replies; collect() then gathers them. Constructing
+ * several fetches before collecting any of them costs a single round trip
+ * in total, instead of one per property.
+ */
+class PropertyFetch {
+public:
+    PropertyFetch(Display* display, ::Window window, unsigned int fields);
+    ~PropertyFetch();
+
+    PropertyFetch(PropertyFetch&& other) noexcept;
+    PropertyFetch(const PropertyFetch&) = delete;
+    PropertyFetch& operator=(const PropertyFetch&) = delete;
+    PropertyFetch& operator=(PropertyFetch&&) = delete;
+
+    ::Window get_window() const { return window_; }
+
+    /**
+     * @brief Wait for and parse the replies
+     * @return false if the window no longer exists
+     */
+    bool collect(WindowProperties& props);
+
+private:
+    void discard();
+
+    xcb_connection_t* conn_;
+    ::Window window_;
+    unsigned int fields_;
+    bool pending_;
+
+    xcb_get_window_attributes_cookie_t attributes_cookie_;
+    xcb_get_geometry_cookie_t geometry_cookie_;
+    xcb_get_property_cookie_t net_wm_name_cookie_;
+    xcb_get_property_cookie_t wm_name_cookie_;
+    xcb_get_property_cookie_t class_cookie_;
+    xcb_get_property_cookie_t hints_cookie_;
+    xcb_get_property_cookie_t size_hints_cookie_;
+    xcb_get_property_cookie_t protocols_cookie_;
+    xcb_get_property_cookie_t state_cookie_;
+    xcb_get_property_cookie_t type_cookie_;
+    xcb_get_property_cookie_t sync_counter_cookie_;
+    xcb_get_property_cookie_t strut_partial_cookie_;
+    xcb_get_property_cookie_t strut_cookie_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_WINDOW_PROPERTIES_H
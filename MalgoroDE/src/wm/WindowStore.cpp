@@ -0,0 +1,200 @@
+#include "WindowStore.h"
+#include "WindowProperties.h"
+
+namespace MalgoroDE {
+
+// WindowIndex
+
+static const size_t INITIAL_BUCKETS = 64;
+
+WindowIndex::WindowIndex()
+    : buckets_(INITIAL_BUCKETS)
+    , mask_(INITIAL_BUCKETS - 1)
+    , count_(0)
+{
+}
+
+size_t WindowIndex::bucket_for(::Window xid) const {
+    // Fibonacci hashing spreads the sequential IDs X hands out per client
+    return (static_cast<uint64_t>(xid) * 0x9E3779B97F4A7C15ull >> 32) & mask_;
+}
+
+void WindowIndex::insert(::Window xid, WindowHandle handle) {
+    if ((count_ + 1) * 10 > buckets_.size() * 7) {
+        grow();
+    }
+
+    size_t i = bucket_for(xid);
+    while (buckets_[i].xid != None) {
+        if (buckets_[i].xid == xid) {
+            buckets_[i].handle = handle;
+            return;
+        }
+        i = (i + 1) & mask_;
+    }
+
+    buckets_[i].xid = xid;
+    buckets_[i].handle = handle;
+    count_++;
+}
+
+void WindowIndex::erase(::Window xid) {
+    size_t i = bucket_for(xid);
+    while (buckets_[i].xid != xid) {
+        if (buckets_[i].xid == None) {
+            return;
+        }
+        i = (i + 1) & mask_;
+    }
+
+    // Backward-shift the rest of the probe run so no tombstone is needed
+    size_t hole = i;
+    size_t j = (i + 1) & mask_;
+    while (buckets_[j].xid != None) {
+        size_t home = bucket_for(buckets_[j].xid);
+        if (((j - home) & mask_) >= ((j - hole) & mask_)) {
+            buckets_[hole] = buckets_[j];
+            hole = j;
+        }
+        j = (j + 1) & mask_;
+    }
+
+    buckets_[hole] = Bucket();
+    count_--;
+}
+
+WindowHandle WindowIndex::find(::Window xid) const {
+    if (xid == None) {
+        return WindowHandle();
+    }
+
+    size_t i = bucket_for(xid);
+    while (buckets_[i].xid != None) {
+        if (buckets_[i].xid == xid) {
+            return buckets_[i].handle;
+        }
+        i = (i + 1) & mask_;
+    }
+    return WindowHandle();
+}
+
+void WindowIndex::grow() {
+    std::vector<Bucket> old;
+    old.swap(buckets_);
+
+    buckets_.resize(old.size() * 2);
+    mask_ = buckets_.size() - 1;
+    count_ = 0;
+
+    for (const Bucket& bucket : old) {
+        if (bucket.xid != None) {
+            insert(bucket.xid, bucket.handle);
+        }
+    }
+}
+
+// WindowStore
+
+WindowStore::WindowStore()
+    : free_head_(NO_SLOT)
+    , count_(0)
+{
+}
+
+WindowHandle WindowStore::insert(::Window xwindow, Display* display, const WindowProperties& props) {
+    uint32_t index;
+    if (free_head_ != NO_SLOT) {
+        index = free_head_;
+        free_head_ = slots_[index].next_free;
+    } else {
+        index = slots_.size();
+        slots_.emplace_back();
+    }
+
+    Slot& slot = slots_[index];
+    slot.window.emplace(xwindow, display, props);
+    slot.next_free = NO_SLOT;
+
+    WindowHandle handle;
+    handle.index = index;
+    handle.generation = slot.generation;
+    slot.window->set_handle(handle);
+
+    index_.insert(xwindow, handle);
+    count_++;
+    return handle;
+}
+
+bool WindowStore::erase(WindowHandle handle) {
+    Window* window = get(handle);
+    if (!window) {
+        return false;
+    }
+
+    index_.erase(window->get_xwindow());
+    if (window->get_frame()) {
+        index_.erase(window->get_frame());
+    }
+
+    Slot& slot = slots_[handle.index];
+    slot.window.reset();
+    slot.generation++;
+    slot.next_free = free_head_;
+    free_head_ = handle.index;
+    count_--;
+    return true;
+}
+
+Window* WindowStore::get(WindowHandle handle) {
+    if (handle.index >= slots_.size()) {
+        return nullptr;
+    }
+    Slot& slot = slots_[handle.index];
+    if (slot.generation != handle.generation || !slot.window) {
+        return nullptr;
+    }
+    return &*slot.window;
+}
+
+Window* WindowStore::find(::Window xid) {
+    return get(index_.find(xid));
+}
+
+void WindowStore::index_frame(WindowHandle handle, ::Window frame) {
+    if (frame != None && get(handle)) {
+        index_.insert(frame, handle);
+    }
+}
+
+void WindowStore::unindex_frame(::Window frame) {
+    if (frame != None) {
+        index_.erase(frame);
+    }
+}
+
+// WindowStore::iterator
+
+WindowStore::iterator::iterator(std::deque<Slot>* slots, size_t index)
+    : slots_(slots)
+    , index_(index)
+{
+    skip_free();
+}
+
+Window& WindowStore::iterator::operator*() const {
+    return *(*slots_)[index_].window;
+}
+
+WindowStore::iterator& WindowStore::iterator::operator++() {
+    index_++;
+    skip_free();
+    return *this;
+}
+
+void WindowStore::iterator::skip_free() {
+    while (index_ < slots_->size() && !(*slots_)[index_].window) {
+        index_++;
+    }
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,117 @@
+#ifndef MALGORO_WINDOW_STORE_H
+#define MALGORO_WINDOW_STORE_H
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+#include <X11/Xlib.h>
+#include "Window.h"
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+struct WindowProperties;
+
+/**
+ * @brief Open-addressing hash index from X window IDs to handles
+ *
+ * Linear probing with backward-shift deletion, so there are no tombstones
+ * and lookups never allocate. XID 0 (None) marks an empty bucket.
+ */
+class WindowIndex {
+public:
+    WindowIndex();
+
+    void insert(::Window xid, WindowHandle handle);
+    void erase(::Window xid);
+    WindowHandle find(::Window xid) const;
+    size_t size() const { return count_; }
+
+private:
+    struct Bucket {
+        ::Window xid = None;
+        WindowHandle handle;
+    };
+
+    size_t bucket_for(::Window xid) const;
+    void grow();
+
+    std::vector<Bucket> buckets_;
+    size_t mask_;
+    size_t count_;
+};
+
+/**
+ * @brief Slot map owning every managed Window
+ *
+ * Windows live in chunked contiguous storage (a deque of slots), so their
+ * addresses stay stable while the store grows. Freed slots are recycled
+ * through a free list and their generation bumped. Both client and frame
+ * IDs are indexed, so events on either resolve to the same window.
+ */
+class WindowStore {
+    struct Slot {
+        std::optional<Window> window;
+        uint32_t generation = 0;
+        uint32_t next_free = 0;
+    };
+
+public:
+    WindowStore();
+
+    WindowHandle insert(::Window xwindow, Display* display, const WindowProperties& props);
+    bool erase(WindowHandle handle);
+
+    /**
+     * @brief Resolve a handle
+     * @return nullptr if the handle is stale or invalid
+     */
+    Window* get(WindowHandle handle);
+
+    /**
+     * @brief Look up a window by its client or frame ID
+     */
+    Window* find(::Window xid);
+    WindowHandle find_handle(::Window xid) const { return index_.find(xid); }
+
+    /**
+     * @brief Index a frame ID after the frame has been created
+     */
+    void index_frame(WindowHandle handle, ::Window frame);
+    void unindex_frame(::Window frame);
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    // Iteration over live windows, in slot order
+    class iterator {
+    public:
+        iterator(std::deque<Slot>* slots, size_t index);
+        Window& operator*() const;
+        Window* operator->() const { return &**this; }
+        iterator& operator++();
+        bool operator!=(const iterator& other) const { return index_ != other.index_; }
+
+    private:
+        void skip_free();
+
+        std::deque<Slot>* slots_;
+        size_t index_;
+    };
+
+    iterator begin() { return iterator(&slots_, 0); }
+    iterator end() { return iterator(&slots_, slots_.size()); }
+
+private:
+    static constexpr uint32_t NO_SLOT = 0xffffffffu;
+
+    std::deque<Slot> slots_;
+    uint32_t free_head_;
+    size_t count_;
+    WindowIndex index_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_WINDOW_STORE_H
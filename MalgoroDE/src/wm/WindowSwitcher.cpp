@@ -0,0 +1,125 @@
+#include "WindowSwitcher.h"
+#include "Window.h"
+#include "WindowStore.h"
+#include "Workspace.h"
+#include <X11/keysym.h>
+
+namespace MalgoroDE {
+
+WindowSwitcher::WindowSwitcher(Display* display, ::Window root)
+    : display_(display)
+    , root_(root)
+    , active_(false)
+{
+}
+
+bool WindowSwitcher::is_candidate(const Window& window) const {
+    if (window.is_hidden()) {
+        return false;
+    }
+    if (window.is_minimized() && !policy_.include_minimized) {
+        return false;
+    }
+    if (window.is_skip_taskbar() && !policy_.include_skip_taskbar) {
+        return false;
+    }
+    return true;
+}
+
+WindowHandle WindowSwitcher::find_next(WindowStore& store, const Workspace& workspace,
+                                       WindowHandle from, bool reverse) {
+    auto first = [&]() {
+        return store.get(reverse ? workspace.get_least_recent() : workspace.get_most_recent());
+    };
+    auto advance = [&](const Window& window) {
+        Window* next = store.get(reverse ? Workspace::prev_recent(window) : Workspace::next_recent(window));
+        return next ? next : first();
+    };
+
+    Window* start = store.get(from);
+    if (start && !workspace.has_window(*start)) {
+        start = nullptr;
+    }
+    Window* window = start ? advance(*start) : first();
+
+    // At most one full lap
+    for (int i = 0; window && i < workspace.get_window_count(); ++i) {
+        if (window == start) {
+            break;
+        }
+        if (is_candidate(*window)) {
+            return window->get_handle();
+        }
+        stats_.skipped++;
+        window = advance(*window);
+    }
+    return WindowHandle();
+}
+
+bool WindowSwitcher::begin(WindowStore& store, const Workspace& workspace, WindowHandle focused,
+                           bool reverse, Time time) {
+    if (active_) {
+        step(store, workspace, reverse);
+        return true;
+    }
+
+    WindowHandle selection = find_next(store, workspace, focused, reverse);
+    if (!selection.is_valid()) {
+        return false;
+    }
+
+    // Keep the keyboard after Tab is released, to see Alt come up
+    if (XGrabKeyboard(display_, root_, True, GrabModeAsync, GrabModeAsync, time) != GrabSuccess) {
+        return false;
+    }
+
+    active_ = true;
+    selection_ = selection;
+    stats_.sessions++;
+    stats_.steps++;
+    return true;
+}
+
+bool WindowSwitcher::is_alt_held() const {
+    char keys[32];
+    XQueryKeymap(display_, keys);
+    for (KeySym keysym : { XK_Alt_L, XK_Alt_R }) {
+        KeyCode keycode = XKeysymToKeycode(display_, keysym);
+        if (keycode && (keys[keycode / 8] & (1 << (keycode % 8)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WindowSwitcher::step(WindowStore& store, const Workspace& workspace, bool reverse) {
+    if (!active_) {
+        return;
+    }
+
+    WindowHandle next = find_next(store, workspace, selection_, reverse);
+    if (next.is_valid()) {
+        selection_ = next;
+        stats_.steps++;
+    }
+}
+
+WindowHandle WindowSwitcher::end(bool cancel) {
+    if (!active_) {
+        return WindowHandle();
+    }
+
+    XUngrabKeyboard(display_, CurrentTime);
+    active_ = false;
+
+    WindowHandle selection = selection_;
+    selection_ = WindowHandle();
+    if (cancel) {
+        stats_.cancelled++;
+        return WindowHandle();
+    }
+    stats_.committed++;
+    return selection;
+}
+
+} // namespace MalgoroDE
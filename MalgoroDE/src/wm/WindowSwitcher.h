@@ -0,0 +1,101 @@
+#ifndef MALGORO_WINDOW_SWITCHER_H
+#define MALGORO_WINDOW_SWITCHER_H
+
+#include <X11/Xlib.h>
+#include "WindowHandle.h"
+
+namespace MalgoroDE {
+
+class Window;
+class WindowStore;
+class Workspace;
+
+/**
+ * @brief Alt+Tab switching in most-recently-used order
+ *
+ * Candidates come from the current workspace's MRU member list, which
+ * focus_window() keeps up to date in O(1), so a step costs only the
+ * windows it passes over, however many windows are managed elsewhere.
+ *
+ * While Alt is held the switcher only moves its selection; focus and
+ * stacking are left alone until end() hands the selection back on release.
+ */
+class WindowSwitcher {
+public:
+    // Which windows Alt+Tab offers
+    struct Policy {
+        bool include_minimized = false;
+        bool include_skip_taskbar = false;
+    };
+
+    struct Stats {
+        unsigned long sessions = 0;
+        unsigned long steps = 0;
+        unsigned long skipped = 0;      // Windows passed over by policy
+        unsigned long committed = 0;
+        unsigned long cancelled = 0;
+    };
+
+    WindowSwitcher(Display* display, ::Window root);
+
+    WindowSwitcher(const WindowSwitcher&) = delete;
+    WindowSwitcher& operator=(const WindowSwitcher&) = delete;
+
+    void set_policy(const Policy& policy) { policy_ = policy; }
+    const Policy& get_policy() const { return policy_; }
+
+    bool is_active() const { return active_; }
+    WindowHandle get_selection() const { return selection_; }
+
+    /**
+     * @brief Find the next window after @p from in MRU order, wrapping
+     * @param from Starting window; an invalid handle starts at either end
+     * @return Invalid handle if no window qualifies
+     */
+    WindowHandle find_next(WindowStore& store, const Workspace& workspace,
+                           WindowHandle from, bool reverse);
+
+    /**
+     * @brief Grab the keyboard and select the window after the focused one
+     * @return false if there is nothing to switch to
+     */
+    bool begin(WindowStore& store, const Workspace& workspace, WindowHandle focused,
+               bool reverse, Time time);
+
+    /**
+     * @brief Check whether Alt is still down
+     *
+     * Alt may come up between the Tab press and the keyboard grab, in which
+     * case no release would ever reach the switcher.
+     */
+    bool is_alt_held() const;
+
+    /**
+     * @brief Move the selection one window on
+     */
+    void step(WindowStore& store, const Workspace& workspace, bool reverse);
+
+    /**
+     * @brief Release the keyboard and finish the session
+     * @return The window to focus, or an invalid handle when cancelled
+     */
+    WindowHandle end(bool cancel = false);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    bool is_candidate(const Window& window) const;
+
+    Display* display_;
+    ::Window root_;
+    Policy policy_;
+
+    bool active_;
+    WindowHandle selection_;
+
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_WINDOW_SWITCHER_H
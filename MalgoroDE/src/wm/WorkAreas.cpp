@@ -0,0 +1,104 @@
+#include "WorkAreas.h"
+#include <algorithm>
+
+namespace MalgoroDE {
+
+void WorkAreas::set_strut(WindowHandle owner, const Strut& strut, int workspace) {
+    if (strut.is_empty()) {
+        remove(owner);
+        return;
+    }
+
+    for (Entry& entry : struts_) {
+        if (entry.owner == owner) {
+            if (entry.workspace != workspace || !(entry.strut == strut)) {
+                entry.workspace = workspace;
+                entry.strut = strut;
+                dirty_ = true;
+            }
+            return;
+        }
+    }
+    struts_.push_back(Entry{ owner, workspace, strut });
+    dirty_ = true;
+}
+
+void WorkAreas::remove(WindowHandle owner) {
+    auto it = std::find_if(struts_.begin(), struts_.end(),
+        [&](const Entry& entry) { return entry.owner == owner; });
+    if (it != struts_.end()) {
+        struts_.erase(it);
+        dirty_ = true;
+    }
+}
+
+Layout::Rect WorkAreas::reduce(const Layout::Rect& area, const Layout::Rect& screen,
+                               const Strut& strut) {
+    // Each strut is a band along a screen edge; it only cuts into the
+    // area if its extent along that edge overlaps the area
+    int left = area.x;
+    int top = area.y;
+    int right = area.x + area.width;
+    int bottom = area.y + area.height;
+
+    if (strut.left > 0 && strut.left_start_y < bottom && strut.left_end_y >= area.y) {
+        left = std::max<long>(left, screen.x + strut.left);
+    }
+    if (strut.right > 0 && strut.right_start_y < bottom && strut.right_end_y >= area.y) {
+        right = std::min<long>(right, screen.x + screen.width - strut.right);
+    }
+    if (strut.top > 0 && strut.top_start_x < right && strut.top_end_x >= area.x) {
+        top = std::max<long>(top, screen.y + strut.top);
+    }
+    if (strut.bottom > 0 && strut.bottom_start_x < right && strut.bottom_end_x >= area.x) {
+        bottom = std::min<long>(bottom, screen.y + screen.height - strut.bottom);
+    }
+
+    // A strut that would leave nothing is ignored
+    if (left >= right || top >= bottom) {
+        return area;
+    }
+    return Layout::Rect{ left, top, right - left, bottom - top };
+}
+
+bool WorkAreas::compute(const std::vector<Layout::Rect>& outputs, const Layout::Rect& screen,
+                        int workspaces) {
+    if (!dirty_) {
+        return false;
+    }
+    dirty_ = false;
+    stats_.computes++;
+
+    std::vector<Layout::Rect> areas(workspaces * outputs.size());
+    std::vector<Layout::Rect> desktops(workspaces);
+    for (int workspace = 0; workspace < workspaces; ++workspace) {
+        Layout::Rect desktop = screen;
+        Layout::Rect* row = &areas[workspace * outputs.size()];
+        for (size_t output = 0; output < outputs.size(); ++output) {
+            row[output] = outputs[output];
+        }
+
+        for (const Entry& entry : struts_) {
+            if (entry.workspace != ALL_WORKSPACES && entry.workspace != workspace) {
+                continue;
+            }
+            desktop = reduce(desktop, screen, entry.strut);
+            for (size_t output = 0; output < outputs.size(); ++output) {
+                row[output] = reduce(row[output], screen, entry.strut);
+            }
+        }
+        desktops[workspace] = desktop;
+    }
+
+    bool changed = output_count_ != static_cast<int>(outputs.size()) ||
+                   areas != areas_ || desktops != desktops_;
+    output_count_ = outputs.size();
+    areas_.swap(areas);
+    desktops_.swap(desktops);
+    if (changed) {
+        stats_.changes++;
+    }
+    return changed;
+}
+
+} // namespace MalgoroDE
@@ -0,0 +1,80 @@
+#ifndef MALGORO_WORK_AREAS_H
+#define MALGORO_WORK_AREAS_H
+
+#include <vector>
+#include "Layout.h"
+#include "WindowHandle.h"
+#include "WindowProperties.h"
+
+namespace MalgoroDE {
+
+/**
+ * @brief Per-workspace, per-output space left over by dock struts
+ *
+ * Struts are recorded as their windows map, unmap or change them; only
+ * then, or when the outputs change, is the next compute() a real
+ * recomputation. Everything else reads the cached areas.
+ */
+class WorkAreas {
+public:
+    struct Stats {
+        unsigned long computes = 0;
+        unsigned long changes = 0;  // Computes whose result differed
+    };
+
+    static const int ALL_WORKSPACES = -1;
+
+    /**
+     * @brief Record a window's strut; an empty strut forgets the window
+     * @param workspace Workspace the strut applies to, or ALL_WORKSPACES
+     */
+    void set_strut(WindowHandle owner, const Strut& strut, int workspace);
+    void remove(WindowHandle owner);
+
+    /**
+     * @brief Force the next compute(), e.g. after an output change
+     */
+    void invalidate() { dirty_ = true; }
+    bool is_dirty() const { return dirty_; }
+
+    /**
+     * @brief Recompute every area if a strut or the outputs changed
+     * @param outputs Output geometries
+     * @param screen Root window geometry, which struts are relative to
+     * @return true if any area differs from before
+     */
+    bool compute(const std::vector<Layout::Rect>& outputs, const Layout::Rect& screen,
+                 int workspaces);
+
+    const Layout::Rect& get(int workspace, int output) const {
+        return areas_[workspace * output_count_ + output];
+    }
+
+    /**
+     * @brief Work area of the whole screen, as published in _NET_WORKAREA
+     */
+    const Layout::Rect& get_desktop(int workspace) const { return desktops_[workspace]; }
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct Entry {
+        WindowHandle owner;
+        int workspace;
+        Strut strut;
+    };
+
+    static Layout::Rect reduce(const Layout::Rect& area, const Layout::Rect& screen,
+                               const Strut& strut);
+
+    std::vector<Entry> struts_;         // A handful: one per panel or dock
+    std::vector<Layout::Rect> areas_;   // By workspace, then output
+    std::vector<Layout::Rect> desktops_;
+    int output_count_ = 0;
+    bool dirty_ = true;
+    Stats stats_;
+};
+
+} // namespace MalgoroDE
+
+#endif // MALGORO_WORK_AREAS_H
@@ -0,0 +1,43 @@
+#include "Workspace.h"
+
+namespace MalgoroDE {
+
+Workspace::Workspace(int index, const std::string& name)
+    : index_(index)
+    , name_(name)
+    , active_(false)
+{
+}
+
+Workspace::~Workspace() {
+}
+
+void Workspace::add_window(WindowStore& store, Window& window, bool most_recent) {
+    if (MemberList::contains(window)) {
+        return;
+    }
+    if (most_recent) {
+        windows_.push_front(store, window);
+    } else {
+        windows_.push_back(store, window);
+    }
+    window.set_workspace(index_);
+}
+
+void Workspace::remove_window(WindowStore& store, Window& window) {
+    if (has_window(window)) {
+        windows_.remove(store, window);
+    }
+}
+
+bool Workspace::has_window(const Window& window) const {
+    return MemberList::contains(window) && window.get_workspace() == index_;
+}
+
+void Workspace::touch(WindowStore& store, Window& window) {
+    if (has_window(window)) {
+        windows_.move_to_front(store, window);
+    }
+}
+
+} // namespace MalgoroDE
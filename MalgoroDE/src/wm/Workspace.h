@@ -2,18 +2,21 @@
 #define MALGORO_WORKSPACE_H
 
 #include <string>
-#include <vector>
-#include <memory>
+#include "HandleList.h"
 
 namespace MalgoroDE {
 
-class Window;
-
 /**
  * @brief Represents a virtual desktop/workspace
+ *
+ * Members are threaded through Window::workspace_link in most-recently-used
+ * order, so adding, removing, moving a window between workspaces and
+ * marking it used are all O(1) and never copy or allocate.
  */
 class Workspace {
 public:
+    using MemberList = HandleList<&Window::workspace_link>;
+
     Workspace(int index, const std::string& name = "");
     ~Workspace();
 
@@ -23,27 +26,30 @@ public:
     void set_name(const std::string& name) { name_ = name; }
 
     // Window management
-    void add_window(std::shared_ptr<Window> window);
-    void remove_window(std::shared_ptr<Window> window);
-    bool has_window(std::shared_ptr<Window> window) const;
-    std::vector<std::shared_ptr<Window>> get_windows() const { return windows_; }
+    void add_window(WindowStore& store, Window& window, bool most_recent = true);
+    void remove_window(WindowStore& store, Window& window);
+    bool has_window(const Window& window) const;
     int get_window_count() const { return windows_.size(); }
 
-    // Visibility
-    void show();
-    void hide();
+    /**
+     * @brief Make a window the most recently used on this workspace
+     */
+    void touch(WindowStore& store, Window& window);
+
+    // Members, most recently used first
+    WindowHandle get_most_recent() const { return windows_.front(); }
+    WindowHandle get_least_recent() const { return windows_.back(); }
+    static WindowHandle next_recent(const Window& window) { return MemberList::next(window); }
+    static WindowHandle prev_recent(const Window& window) { return MemberList::prev(window); }
+
+    // Visibility; frames are shown and hidden by WindowManager::switch_workspace()
     bool is_active() const { return active_; }
     void set_active(bool active) { active_ = active; }
 
-    // Layout
-    void tile_horizontally();
-    void tile_vertically();
-    void cascade();
-
 private:
     int index_;
     std::string name_;
-    std::vector<std::shared_ptr<Window>> windows_;
+    MemberList windows_;
     bool active_;
 };
 
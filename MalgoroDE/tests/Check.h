@@ -0,0 +1,28 @@
+#ifndef MALGORO_CHECK_H
+#define MALGORO_CHECK_H
+
+#include <iostream>
+
+namespace MalgoroDE {
+
+/**
+ * @brief Failure count of the running test executable
+ */
+inline int& check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+} // namespace MalgoroDE
+
+// Records a failure and carries on, so one run reports every broken case
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition   \
+                      << ") failed" << std::endl;                               \
+            ::MalgoroDE::check_failures()++;                                    \
+        }                                                                       \
+    } while (0)
+
+#endif // MALGORO_CHECK_H
@@ -0,0 +1,147 @@
+#include "Check.h"
+#include "wm/Layout.h"
+#include <vector>
+
+using namespace MalgoroDE;
+
+namespace {
+
+const Layout::Kind kinds[] = {
+    Layout::Kind::TILE,
+    Layout::Kind::COLUMNS,
+    Layout::Kind::MASTER_STACK,
+    Layout::Kind::GRID,
+    Layout::Kind::CASCADE
+};
+
+const int MAX_COUNT = 12;
+
+std::vector<Layout::Rect> arrange(const Layout& layout, const Layout::Rect& area, int count) {
+    std::vector<Layout::Rect> rects(count);
+    layout.arrange(area, count, 0, rects.data());
+    return rects;
+}
+
+bool inside(const Layout::Rect& rect, const Layout::Rect& area) {
+    return rect.width > 0 && rect.height > 0 &&
+           rect.x >= area.x && rect.y >= area.y &&
+           rect.x + rect.width <= area.x + area.width &&
+           rect.y + rect.height <= area.y + area.height;
+}
+
+bool overlap(const Layout::Rect& a, const Layout::Rect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+void test_create() {
+    CHECK(Layout::create(Layout::Kind::NONE) == nullptr);
+    for (Layout::Kind kind : kinds) {
+        std::unique_ptr<Layout> layout = Layout::create(kind);
+        CHECK(layout && layout->get_kind() == kind);
+    }
+}
+
+void test_within_area() {
+    // An odd-sized, offset area exercises the remainder distribution
+    const Layout::Rect area{ 37, 21, 1001, 767 };
+    for (Layout::Kind kind : kinds) {
+        std::unique_ptr<Layout> layout = Layout::create(kind);
+        for (int count = 1; count <= MAX_COUNT; ++count) {
+            for (const Layout::Rect& rect : arrange(*layout, area, count)) {
+                CHECK(inside(rect, area));
+            }
+        }
+    }
+}
+
+void test_tiling_covers_area() {
+    // Every layout but cascade partitions the area exactly
+    const Layout::Rect area{ 0, 24, 1366, 744 };
+    for (Layout::Kind kind : kinds) {
+        if (kind == Layout::Kind::CASCADE) {
+            continue;
+        }
+        std::unique_ptr<Layout> layout = Layout::create(kind);
+        for (int count = 1; count <= MAX_COUNT; ++count) {
+            std::vector<Layout::Rect> rects = arrange(*layout, area, count);
+            long covered = 0;
+            for (int i = 0; i < count; ++i) {
+                covered += static_cast<long>(rects[i].width) * rects[i].height;
+                for (int j = i + 1; j < count; ++j) {
+                    CHECK(!overlap(rects[i], rects[j]));
+                }
+            }
+            // Grids with an incomplete last row leave its tail empty
+            if (kind != Layout::Kind::GRID) {
+                CHECK(covered == static_cast<long>(area.width) * area.height);
+            }
+        }
+    }
+}
+
+void test_partial_arrange() {
+    // arrange() from a later slot leaves earlier slots alone and computes
+    // the rest exactly as a full arrangement would
+    const Layout::Rect area{ 0, 0, 1920, 1080 };
+    const Layout::Rect sentinel{ -1, -1, -1, -1 };
+    for (Layout::Kind kind : kinds) {
+        std::unique_ptr<Layout> layout = Layout::create(kind);
+        for (int count = 1; count <= MAX_COUNT; ++count) {
+            std::vector<Layout::Rect> full = arrange(*layout, area, count);
+            for (int first = 0; first < count; ++first) {
+                std::vector<Layout::Rect> partial(count, sentinel);
+                layout->arrange(area, count, first, partial.data());
+                for (int i = 0; i < count; ++i) {
+                    CHECK(partial[i] == (i < first ? sentinel : full[i]));
+                }
+            }
+        }
+    }
+}
+
+void test_stable_slots() {
+    // Slots reported stable must come out the same for both counts
+    const Layout::Rect area{ 0, 0, 1920, 1080 };
+    for (Layout::Kind kind : kinds) {
+        std::unique_ptr<Layout> layout = Layout::create(kind);
+        for (int before = 1; before <= MAX_COUNT; ++before) {
+            std::vector<Layout::Rect> old_rects = arrange(*layout, area, before);
+            for (int after = 1; after <= MAX_COUNT; ++after) {
+                std::vector<Layout::Rect> new_rects = arrange(*layout, area, after);
+                int stable = layout->stable_slots(before, after);
+                CHECK(stable >= 0 && stable <= std::min(before, after));
+                for (int i = 0; i < stable; ++i) {
+                    CHECK(old_rects[i] == new_rects[i]);
+                }
+            }
+        }
+    }
+}
+
+void test_master_stack() {
+    const Layout::Rect area{ 0, 0, 1000, 600 };
+    std::unique_ptr<Layout> layout = Layout::create(Layout::Kind::MASTER_STACK);
+
+    std::vector<Layout::Rect> one = arrange(*layout, area, 1);
+    CHECK(one[0] == area);
+
+    std::vector<Layout::Rect> three = arrange(*layout, area, 3);
+    CHECK(three[0].x == 0 && three[0].height == 600);
+    CHECK(three[1].x == three[0].width && three[2].x == three[0].width);
+    CHECK(three[1].height + three[2].height == 600);
+    CHECK(layout->stable_slots(1, 2) == 0);
+    CHECK(layout->stable_slots(2, 3) == 1);
+}
+
+} // namespace
+
+int main() {
+    test_create();
+    test_within_area();
+    test_tiling_covers_area();
+    test_partial_arrange();
+    test_stable_slots();
+    test_master_stack();
+    return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "Check.h"
+#include "wm/WorkAreas.h"
+#include <climits>
+
+using namespace MalgoroDE;
+
+namespace {
+
+const Layout::Rect screen{ 0, 0, 3840, 1080 };
+const std::vector<Layout::Rect> outputs = {
+    { 0, 0, 1920, 1080 },
+    { 1920, 0, 1920, 1080 }
+};
+const int WORKSPACES = 4;
+
+WindowHandle handle(uint32_t index) {
+    WindowHandle result;
+    result.index = index;
+    return result;
+}
+
+// A panel along the bottom of the left output only
+Strut left_panel() {
+    Strut strut;
+    strut.bottom = 32;
+    strut.bottom_start_x = 0;
+    strut.bottom_end_x = 1919;
+    return strut;
+}
+
+// A plain _NET_WM_STRUT dock across the whole top edge
+Strut top_dock() {
+    Strut strut;
+    strut.top = 24;
+    strut.top_start_x = 0;
+    strut.top_end_x = INT_MAX;
+    return strut;
+}
+
+void test_no_struts() {
+    WorkAreas areas;
+    CHECK(areas.is_dirty());
+    CHECK(areas.compute(outputs, screen, WORKSPACES));
+    CHECK(!areas.is_dirty());
+    for (int workspace = 0; workspace < WORKSPACES; ++workspace) {
+        CHECK(areas.get(workspace, 0) == outputs[0]);
+        CHECK(areas.get(workspace, 1) == outputs[1]);
+        CHECK(areas.get_desktop(workspace) == screen);
+    }
+
+    // Nothing changed: no recomputation
+    CHECK(!areas.compute(outputs, screen, WORKSPACES));
+    CHECK(areas.get_stats().computes == 1);
+}
+
+void test_partial_strut() {
+    WorkAreas areas;
+    areas.set_strut(handle(1), left_panel(), WorkAreas::ALL_WORKSPACES);
+    CHECK(areas.compute(outputs, screen, WORKSPACES));
+
+    // Only the output the panel's extent overlaps loses space
+    CHECK(areas.get(0, 0) == (Layout::Rect{ 0, 0, 1920, 1048 }));
+    CHECK(areas.get(0, 1) == outputs[1]);
+    CHECK(areas.get_desktop(0) == (Layout::Rect{ 0, 0, 3840, 1048 }));
+}
+
+void test_full_strut() {
+    WorkAreas areas;
+    areas.set_strut(handle(1), top_dock(), WorkAreas::ALL_WORKSPACES);
+    areas.set_strut(handle(2), left_panel(), WorkAreas::ALL_WORKSPACES);
+    CHECK(areas.compute(outputs, screen, WORKSPACES));
+    CHECK(areas.get(2, 0) == (Layout::Rect{ 0, 24, 1920, 1024 }));
+    CHECK(areas.get(2, 1) == (Layout::Rect{ 1920, 24, 1920, 1056 }));
+}
+
+void test_per_workspace_strut() {
+    WorkAreas areas;
+    areas.set_strut(handle(1), top_dock(), 2);
+    CHECK(areas.compute(outputs, screen, WORKSPACES));
+    CHECK(areas.get(2, 1) == (Layout::Rect{ 1920, 24, 1920, 1056 }));
+    CHECK(areas.get(1, 1) == outputs[1]);
+    CHECK(areas.get_desktop(2) == (Layout::Rect{ 0, 24, 3840, 1056 }));
+    CHECK(areas.get_desktop(3) == screen);
+}
+
+void test_incremental_updates() {
+    WorkAreas areas;
+    areas.compute(outputs, screen, WORKSPACES);
+
+    // Setting the same strut again does not dirty the areas
+    areas.set_strut(handle(1), left_panel(), WorkAreas::ALL_WORKSPACES);
+    CHECK(areas.is_dirty());
+    CHECK(areas.compute(outputs, screen, WORKSPACES));
+    areas.set_strut(handle(1), left_panel(), WorkAreas::ALL_WORKSPACES);
+    CHECK(!areas.is_dirty());
+
+    // An empty strut forgets the window, restoring the full outputs
+    areas.set_strut(handle(1), Strut(), WorkAreas::ALL_WORKSPACES);
+    CHECK(areas.is_dirty());
+    CHECK(areas.compute(outputs, screen, WORKSPACES));
+    CHECK(areas.get(0, 0) == outputs[0]);
+
+    // Removing an unknown window is a no-op
+    areas.remove(handle(7));
+    CHECK(!areas.is_dirty());
+
+    // Invalidated without a change: recomputed, but reported unchanged
+    areas.invalidate();
+    CHECK(!areas.compute(outputs, screen, WORKSPACES));
+    CHECK(areas.get_stats().computes == 4);
+}
+
+void test_strut_leaving_nothing() {
+    // A strut that would leave no area is ignored
+    WorkAreas areas;
+    Strut strut;
+    strut.left = 4000;
+    strut.left_start_y = 0;
+    strut.left_end_y = 1079;
+    areas.set_strut(handle(1), strut, WorkAreas::ALL_WORKSPACES);
+    areas.compute(outputs, screen, WORKSPACES);
+    CHECK(areas.get(0, 0) == outputs[0]);
+    CHECK(areas.get(0, 1) == outputs[1]);
+}
+
+void test_output_change() {
+    WorkAreas areas;
+    areas.set_strut(handle(1), left_panel(), WorkAreas::ALL_WORKSPACES);
+    areas.compute(outputs, screen, WORKSPACES);
+
+    // One output unplugged: the areas follow after invalidate()
+    const std::vector<Layout::Rect> single = { outputs[0] };
+    const Layout::Rect small_screen{ 0, 0, 1920, 1080 };
+    areas.invalidate();
+    CHECK(areas.compute(single, small_screen, WORKSPACES));
+    CHECK(areas.get(1, 0) == (Layout::Rect{ 0, 0, 1920, 1048 }));
+    CHECK(areas.get_desktop(1) == (Layout::Rect{ 0, 0, 1920, 1048 }));
+}
+
+} // namespace
+
+int main() {
+    test_no_struts();
+    test_partial_strut();
+    test_full_strut();
+    test_per_workspace_strut();
+    test_incremental_updates();
+    test_strut_leaving_nothing();
+    test_output_change();
+    return check_failures() == 0 ? 0 : 1;
+}